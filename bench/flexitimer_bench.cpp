@@ -0,0 +1,499 @@
+/**
+    @file flexitimer_bench.cpp
+    @brief FlexiTimer Scheduler Library - benchmarks
+
+    Hot path benchmarks of the configured engine, parameterized over the number of timers of the
+    context and the percentage of them that are active. Run with --benchmark_out=<file>
+    --benchmark_out_format=json to keep the results for comparison.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "flexitimer.h"
+#if defined(__linux__) && (FLEXITIMER_QUEUE_SIZE > 0)
+#include "flexitimer_shards.h"
+#endif
+
+namespace
+{
+const timer_time_t LONG_TIMEOUT = (FLEXITIMER_COUNTER_MAX < 1000000u) ? FLEXITIMER_COUNTER_MAX : 1000000u; // rarely expires within a benchmark run
+
+flexitimer_ctx_t ctx;
+std::vector<flexitimer_timer_t> storage;
+uint64_t fired = 0;
+
+extern "C" void count_callback(timer_id_t id)
+{
+    (void)id;
+    fired++;
+}
+
+extern "C" void restart_callback(timer_id_t id)
+{
+    fired++;
+    flexitimer_ctx_restart(&ctx, id);
+}
+
+/* Registers the benchmark callbacks when the records store callback table indexes */
+void use_callbacks(flexitimer_ctx_t *context)
+{
+#if FLEXITIMER_CALLBACK_TABLE
+    static const timer_callback_t callbacks[] = {count_callback, restart_callback};
+    flexitimer_ctx_set_callbacks(context, callbacks, 2u);
+#else
+    (void)context;
+#endif
+}
+
+/* Largest context the configuration can hold */
+int64_t max_timers()
+{
+    int64_t limit = (int64_t)1 << (8 * sizeof(timer_id_t));
+#if (FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_SCAN) && FLEXITIMER_SCAN_SOA
+    limit = (limit < FLEXITIMER_MAX_TIMERS) ? limit : FLEXITIMER_MAX_TIMERS;
+#endif
+    return (limit < 65536) ? limit : 65536;
+}
+
+/* Timer count x active percentage */
+void timer_args(benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({"timers", "active%"});
+
+    for(int64_t timers = 16; timers <= max_timers(); timers *= 4)
+    {
+        for(int64_t active : {1, 10, 50, 100})
+        {
+            bench->Args({timers, active});
+        }
+    }
+}
+
+/* Timer count only, every timer active */
+void count_args(benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({"timers"});
+
+    for(int64_t timers = 16; timers <= max_timers(); timers *= 4)
+    {
+        bench->Args({timers});
+    }
+}
+
+/* Initializes the context, returns the number of timers */
+uint32_t setup(benchmark::State &state)
+{
+    uint32_t timers = (uint32_t)state.range(0);
+    storage.assign(timers, flexitimer_timer_t());
+    flexitimer_ctx_init(&ctx, storage.data(), timers);
+    use_callbacks(&ctx);
+    fired = 0;
+    return timers;
+}
+
+/* Ids of the active timers, spread evenly over the context */
+std::vector<timer_id_t> spread(uint32_t timers, int64_t percent)
+{
+    std::vector<timer_id_t> ids;
+    uint32_t count = (uint32_t)((timers * percent + 99) / 100);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        ids.push_back((timer_id_t)(((uint64_t)i * timers) / count));
+    }
+
+    return ids;
+}
+
+void report(benchmark::State &state, uint32_t timers)
+{
+    state.counters["fired/s"] = benchmark::Counter((double)fired, benchmark::Counter::kIsRate);
+    state.counters["bytes/timer"] = (double)sizeof(flexitimer_timer_t) + ((double)sizeof(flexitimer_ctx_t) / timers);
+}
+}
+
+/* Handler cost of a tick when no timer expires */
+static void BM_HandlerIdleTick(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+
+    for(timer_id_t id : spread(timers, state.range(1)))
+    {
+        flexitimer_ctx_start(&ctx, id, TIMER_TYPE_PERIODIC, LONG_TIMEOUT, count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    report(state, timers);
+}
+BENCHMARK(BM_HandlerIdleTick)->Apply(timer_args);
+
+/* Handler cost of a tick when a quarter of the active timers expire every few ticks */
+static void BM_HandlerExpiringMix(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+    uint32_t n = 0;
+
+    for(timer_id_t id : spread(timers, state.range(1)))
+    {
+        timer_time_t timeout = ((n++ % 4u) == 0u) ? (1u + (id % 8u)) : LONG_TIMEOUT;
+        flexitimer_ctx_start(&ctx, id, TIMER_TYPE_PERIODIC, timeout, count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    report(state, timers);
+}
+BENCHMARK(BM_HandlerExpiringMix)->Apply(timer_args);
+
+/* Periodic timers of staggered periods, re-armed by the engine */
+static void BM_PeriodicWorkload(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+
+    for(uint32_t id = 0; id < timers; id++)
+    {
+        flexitimer_ctx_start(&ctx, (timer_id_t)id, TIMER_TYPE_PERIODIC, 10u + (id % 90u), count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    report(state, timers);
+}
+BENCHMARK(BM_PeriodicWorkload)->Apply(count_args);
+
+/* The same load built from single-shot timers restarted by their callback */
+static void BM_SingleShotWorkload(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+
+    for(uint32_t id = 0; id < timers; id++)
+    {
+        flexitimer_ctx_start(&ctx, (timer_id_t)id, TIMER_TYPE_SINGLESHOT, 10u + (id % 90u), restart_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    report(state, timers);
+}
+BENCHMARK(BM_SingleShotWorkload)->Apply(count_args);
+
+/* Start and cancel of one timer next to the active ones */
+static void BM_StartCancel(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+    timer_id_t spare = (timer_id_t)(timers - 1u);
+
+    for(timer_id_t id : spread(timers - 1u, state.range(1)))
+    {
+        flexitimer_ctx_start(&ctx, id, TIMER_TYPE_PERIODIC, LONG_TIMEOUT, count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_start(&ctx, spare, TIMER_TYPE_SINGLESHOT, 500u, count_callback);
+        flexitimer_ctx_cancel(&ctx, spare);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2);
+    report(state, timers);
+}
+BENCHMARK(BM_StartCancel)->Apply(timer_args);
+
+/* Start and cancel of every timer, one call per timer against one bulk call */
+static void BM_StartManyCancelMany(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+
+    for(auto _ : state)
+    {
+        if(state.range(1) != 0)
+        {
+            flexitimer_ctx_start_many(&ctx, NULL, timers, TIMER_TYPE_SINGLESHOT, 500u, count_callback);
+            flexitimer_ctx_cancel_many(&ctx, NULL, timers);
+        }
+        else
+        {
+            for(uint32_t i = 0; i < timers; i++)
+            {
+                flexitimer_ctx_start(&ctx, (timer_id_t)i, TIMER_TYPE_SINGLESHOT, 500u, count_callback);
+            }
+
+            for(uint32_t i = 0; i < timers; i++)
+            {
+                flexitimer_ctx_cancel(&ctx, (timer_id_t)i);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * timers * 2);
+    report(state, timers);
+}
+BENCHMARK(BM_StartManyCancelMany)->Apply([](benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({"timers", "bulk"});
+
+    for(int64_t timers = 16; timers <= max_timers(); timers *= 4)
+    {
+        bench->Args({timers, 0})->Args({timers, 1});
+    }
+});
+
+#if FLEXITIMER_GROUPS
+/* Pause and resume of every timer, as one group against one call per timer */
+static void BM_GroupPauseResume(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+    flexitimer_group_t group;
+    flexitimer_ctx_set_groups(&ctx, &group, 1u);
+
+    for(uint32_t i = 0; i < timers; i++)
+    {
+        flexitimer_ctx_start_in_group(&ctx, (timer_id_t)i, 0u, TIMER_TYPE_PERIODIC, LONG_TIMEOUT, count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        if(state.range(1) != 0)
+        {
+            flexitimer_ctx_group_pause(&ctx, 0u);
+            flexitimer_ctx_group_resume(&ctx, 0u);
+        }
+        else
+        {
+            for(uint32_t i = 0; i < timers; i++)
+            {
+                flexitimer_ctx_pause(&ctx, (timer_id_t)i);
+            }
+
+            for(uint32_t i = 0; i < timers; i++)
+            {
+                flexitimer_ctx_resume(&ctx, (timer_id_t)i);
+            }
+        }
+
+        flexitimer_ctx_handler(&ctx); // the group clock moves on between pauses
+    }
+
+    state.SetItemsProcessed(state.iterations() * timers * 2);
+    report(state, timers);
+}
+BENCHMARK(BM_GroupPauseResume)->Apply([](benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({"timers", "group"});
+
+    for(int64_t timers = 16; timers <= max_timers(); timers *= 4)
+    {
+        bench->Args({timers, 0})->Args({timers, 1});
+    }
+});
+#endif
+
+#if FLEXITIMER_PRIORITIES
+/* Handler call cost in an expiry storm, every timer due on every tick, without and with a dispatch budget */
+static void BM_BudgetedStorm(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+    flexitimer_ctx_set_budget(&ctx, (uint32_t)state.range(1), 0u, NULL);
+    flexitimer_ctx_set_priority(&ctx, 0, FLEXITIMER_PRIORITY_HIGH);
+
+    for(uint32_t i = 0; i < timers; i++)
+    {
+        flexitimer_ctx_start(&ctx, (timer_id_t)i, TIMER_TYPE_PERIODIC, 1u, count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    report(state, timers);
+}
+BENCHMARK(BM_BudgetedStorm)->Apply([](benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({"timers", "budget"});
+
+    for(int64_t timers = 64; timers <= max_timers(); timers *= 4)
+    {
+        bench->Args({timers, 0})->Args({timers, 16});
+    }
+});
+#endif
+
+#if FLEXITIMER_TRACE
+/* Steady clock in ns for the trace timestamps */
+extern "C" uint64_t steady_ns(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Start/cancel cost with every operation recorded in the event trace, with and without timestamps */
+static void BM_TracedStartCancel(benchmark::State &state)
+{
+    std::vector<flexitimer_trace_event_t> trace(4096);
+    uint32_t timers = setup(state);
+    flexitimer_ctx_set_trace(&ctx, trace.data(), (uint32_t)trace.size(), (state.range(1) != 0) ? steady_ns : NULL);
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_start(&ctx, 0, TIMER_TYPE_SINGLESHOT, 500u, count_callback);
+        flexitimer_ctx_cancel(&ctx, 0);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2);
+    report(state, timers);
+}
+BENCHMARK(BM_TracedStartCancel)->ArgNames({"timers", "clock"})->Args({64, 0})->Args({64, 1});
+#endif
+
+/* Delay of the active timers in turn */
+static void BM_Delay(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+    std::vector<timer_id_t> ids = spread(timers, state.range(1));
+    size_t next = 0;
+
+    for(timer_id_t id : ids)
+    {
+        flexitimer_ctx_start(&ctx, id, TIMER_TYPE_SINGLESHOT, 1000u + id, count_callback);
+    }
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_delay(&ctx, ids[next], 1u);
+        next = (next + 1u < ids.size()) ? (next + 1u) : 0u;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    report(state, timers);
+}
+BENCHMARK(BM_Delay)->Apply(timer_args);
+
+#if FLEXITIMER_SNAPSHOT
+/* Handler cost of a tick with expiring timers while another thread polls snapshots of all of them */
+static void BM_HandlerWithSnapshotReader(benchmark::State &state)
+{
+    uint32_t timers = setup(state);
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> snapshots(0);
+
+    for(timer_id_t id : spread(timers, 100))
+    {
+        flexitimer_ctx_start(&ctx, id, TIMER_TYPE_PERIODIC, 1u + (id % 8u), count_callback);
+    }
+
+    std::thread reader([timers, &done, &snapshots]()
+    {
+        std::vector<flexitimer_snapshot_t> copies(timers);
+
+        while(!done)
+        {
+            flexitimer_ctx_snapshot_all(&ctx, copies.data(), timers);
+            snapshots++;
+        }
+    });
+
+    for(auto _ : state)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    done = true;
+    reader.join();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["snapshots/s"] = benchmark::Counter((double)snapshots, benchmark::Counter::kIsRate);
+    report(state, timers);
+}
+BENCHMARK(BM_HandlerWithSnapshotReader)->Apply(count_args);
+#endif
+
+#if defined(__linux__) && (FLEXITIMER_QUEUE_SIZE > 0)
+namespace
+{
+const uint32_t SHARD_TIMERS = 64u;
+
+flexitimer_shards_t sharded;
+std::vector<flexitimer_shard_t> shards;
+std::vector<flexitimer_timer_t> shard_storage;
+
+uint32_t shard_count()
+{
+    uint32_t cores = std::thread::hardware_concurrency();
+    cores = (cores > 0u) ? cores : 1u;
+    return (cores < FLEXITIMER_SHARDS_MAX) ? cores : FLEXITIMER_SHARDS_MAX;
+}
+
+void shards_setup(const benchmark::State &)
+{
+    uint32_t count = shard_count();
+    flexitimer_shards_config_t config = {1000000u, 50000u, FLEXITIMER_SHARDS_FREE, -1};
+    shards.assign(count, flexitimer_shard_t());
+    shard_storage.assign((size_t)count * SHARD_TIMERS, flexitimer_timer_t());
+    flexitimer_shards_init(&sharded, shards.data(), count, shard_storage.data(), SHARD_TIMERS, &config);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        use_callbacks(&shards[i].ctx);
+    }
+}
+
+void shards_teardown(const benchmark::State &)
+{
+    flexitimer_shards_deinit(&sharded);
+}
+}
+
+/* Start/cancel throughput of the sharded scheduler, every thread posts to its own shard */
+static void BM_ShardedStartCancel(benchmark::State &state)
+{
+    uint32_t shard = (uint32_t)state.thread_index() % sharded.count;
+    timer_id_t id = 0;
+
+    for(auto _ : state)
+    {
+        uint32_t key = flexitimer_shards_key(&sharded, shard, id);
+
+        /* A full queue waits for the shard thread to apply it */
+        while(flexitimer_shards_start(&sharded, key, TIMER_TYPE_SINGLESHOT, LONG_TIMEOUT, count_callback) == FLEXITIMER_ERROR_FULL)
+        {
+            std::this_thread::yield();
+        }
+
+        while(flexitimer_shards_cancel(&sharded, key) == FLEXITIMER_ERROR_FULL)
+        {
+            std::this_thread::yield();
+        }
+
+        id = (timer_id_t)((id + 1u) % SHARD_TIMERS);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2);
+    state.counters["shards"] = (double)sharded.count;
+}
+BENCHMARK(BM_ShardedStartCancel)->Setup(shards_setup)->Teardown(shards_teardown)->ThreadRange(1, (int)shard_count())->UseRealTime();
+#endif
@@ -14,9 +14,12 @@
     @license MIT License
 
     This example manages an industrial device that reads sensors and I/Os periodically, also deals with sensor errors.
+    The periodic readings are a static timer table in read-only memory, their phases keep them
+    off the same ticks at startup. The power switch sequence uses a dynamic timer.
 */
 
 #include "flexitimer.h"
+#include "flexitimer_static.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -24,10 +27,23 @@
 
 #define NUM_SENSORS     6
 #define ID_IO           NUM_SENSORS
-#define ID_PWRSWITCH    (NUM_SENSORS + 1)
+#define ID_PWRSWITCH    0
+#define TICK_MS         100
 int sensor_error = 0;
 int sensor_id = 0;
 
+void read_sensor(timer_id_t id);
+void read_io(timer_id_t id);
+
+FLEXITIMER_STATIC_TABLE(readings,
+                        FLEXITIMER_STATIC_TIMER(0, TIMER_TYPE_PERIODIC, 5, 1, read_sensor),
+                        FLEXITIMER_STATIC_TIMER(1, TIMER_TYPE_PERIODIC, 7, 2, read_sensor),
+                        FLEXITIMER_STATIC_TIMER(2, TIMER_TYPE_PERIODIC, 9, 4, read_sensor),
+                        FLEXITIMER_STATIC_TIMER(3, TIMER_TYPE_PERIODIC, 11, 5, read_sensor),
+                        FLEXITIMER_STATIC_TIMER(4, TIMER_TYPE_PERIODIC, 13, 7, read_sensor),
+                        FLEXITIMER_STATIC_TIMER(5, TIMER_TYPE_PERIODIC, 15, 8, read_sensor),
+                        FLEXITIMER_STATIC_TIMER(ID_IO, TIMER_TYPE_PERIODIC, 3, 0, read_io));
+
 void read_sensor(timer_id_t id)
 {
     printf("Reading sensor %d\n", id);
@@ -38,7 +54,7 @@ void read_sensor(timer_id_t id)
         printf("Error on sensor %d, reading stopped\n", id);
         sensor_error = 1;
         sensor_id = id;
-        flexitimer_pause(id);
+        flexitimer_static_pause(&readings, id);
     }
 }
 
@@ -50,7 +66,7 @@ void read_io(timer_id_t id)
 void sensor_power_settle(timer_id_t id)
 {
     printf("Sensor %d power settled\n", sensor_id);
-    flexitimer_resume(sensor_id);
+    flexitimer_static_resume(&readings, sensor_id);
     sensor_error = 0;
     printf("Sensor reading resumes for sensor %d\n", sensor_id);
 }
@@ -67,6 +83,14 @@ void sensor_power_off(timer_id_t id)
     flexitimer_start(ID_PWRSWITCH, TIMER_TYPE_SINGLESHOT, 10, sensor_power_on);
 }
 
+void sleep_ticks(timer_time_t ticks)
+{
+    struct timespec ts;
+    ts.tv_sec = (ticks * TICK_MS) / 1000;
+    ts.tv_nsec = ((ticks * TICK_MS) % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
 void error_handler()
 {
     timer_state_t state;
@@ -81,22 +105,29 @@ void error_handler()
 int main(void)
 {
     srand(time(NULL));
-    flexitimer_init();
-    int i;
-
-    for(i = 0; i < NUM_SENSORS; i++)
-    {
-        flexitimer_start(i, TIMER_TYPE_PERIODIC, 5 + i * 2, read_sensor);
-    }
-
-    flexitimer_start(ID_IO, TIMER_TYPE_PERIODIC, 3, read_io);
-    i = 1000;
+    flexitimer_init(); // the readings need no start calls
+    timer_time_t elapsed = 0;
 
-    while(i--)
+    while(elapsed < 1000)
     {
-        flexitimer_handler();
+        timer_time_t ticks;
+        timer_time_t dynamic;
+
+        if(FLEXITIMER_OK != flexitimer_static_next_expiry(&readings, &ticks))
+        {
+            ticks = 1;
+        }
+
+        if((FLEXITIMER_OK == flexitimer_next_expiry(&dynamic)) && (dynamic < ticks))
+        {
+            ticks = dynamic;
+        }
+
+        sleep_ticks(ticks); // Sleep until the next deadline, 1 tick is 100 milliseconds
+        flexitimer_static_advance(&readings, ticks);
+        flexitimer_advance(ticks);
         error_handler();
-        usleep(100000); // Sleep for 100 millisecond
+        elapsed += ticks;
     }
 
     return 0;
@@ -0,0 +1,96 @@
+/**
+    @brief FlexiTimer Scheduler Library
+
+    FlexiTimer is a fast and efficient software timer library designed to work seamlessly across
+    any embedded system, operating system, or bare-metal environment.
+    With MISRA C compliance, it ensures safety and reliability, making it ideal for real-time applications.
+    The timer resolution is flexible and depends on the frequency of the handler function calls,
+    providing high precision for various use cases.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+
+    This example runs the scheduler inside an epoll reactor with the Linux timerfd driver.
+    The reactor sleeps until a timer is due or a line arrives on stdin, every line restarts
+    an inactivity timeout. There is no tick loop.
+*/
+
+#include "flexitimer_linux.h"
+#include <stdio.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#define ID_HEARTBEAT    0
+#define ID_INACTIVITY   1
+#define TICK_MS         10
+
+static int quit = 0;
+
+void heartbeat(timer_id_t id)
+{
+    printf("Heartbeat\n");
+}
+
+void inactivity(timer_id_t id)
+{
+    printf("No input for 5 seconds, exiting\n");
+    quit = 1;
+}
+
+int main(void)
+{
+    flexitimer_linux_t driver;
+    struct epoll_event event = {0};
+    int epfd = epoll_create1(0);
+
+    flexitimer_init();
+
+    if((epfd < 0) || (flexitimer_linux_init(&driver, NULL, TICK_MS * 1000000u) != FLEXITIMER_OK))
+    {
+        perror("init");
+        return 1;
+    }
+
+    flexitimer_start(ID_HEARTBEAT, TIMER_TYPE_PERIODIC, 1000 / TICK_MS, heartbeat);
+    flexitimer_start(ID_INACTIVITY, TIMER_TYPE_SINGLESHOT, 5000 / TICK_MS, inactivity);
+    flexitimer_linux_rearm(&driver);
+
+    event.events = EPOLLIN;
+    event.data.fd = flexitimer_linux_fd(&driver);
+    epoll_ctl(epfd, EPOLL_CTL_ADD, event.data.fd, &event);
+    event.data.fd = STDIN_FILENO;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, STDIN_FILENO, &event);
+
+    while(!quit)
+    {
+        if(epoll_wait(epfd, &event, 1, -1) != 1)
+        {
+            continue;
+        }
+
+        if(event.data.fd == STDIN_FILENO)
+        {
+            char line[128];
+
+            if(fgets(line, sizeof(line), stdin) == NULL)
+            {
+                break;
+            }
+
+            printf("Input: %s", line);
+            flexitimer_restart(ID_INACTIVITY);
+            flexitimer_linux_rearm(&driver);
+        }
+        else
+        {
+            flexitimer_linux_dispatch(&driver);
+        }
+    }
+
+    flexitimer_linux_deinit(&driver);
+    close(epfd);
+    return 0;
+}
@@ -14,10 +14,12 @@
     @license MIT License
 
     This example implements a thread watchdog for five threads.
-    Each thread must call the flexitimer_delay function before the timer expires, or the thread is considered stuck and is restarted.
+    Each thread must kick its watchdog timer before it expires, or the thread is considered stuck and is restarted.
+    The threads kick with flexitimer_post_restart, which is safe to call from any thread while the main loop runs the handler.
+    The watchdog callbacks restart the threads on a worker pool, so a slow restart does not hold up the handler.
 */
 
-#include "flexitimer.h"
+#include "flexitimer_workers.h"
 #include <stdio.h>
 #include <pthread.h>
 #include <unistd.h>
@@ -28,6 +30,8 @@
 #define WATCHDOG_TIMEOUT 5 // 5 seconds
 
 pthread_t threads[NUM_THREADS];
+flexitimer_workers_t workers;
+flexitimer_worker_slot_t slots[FLEXITIMER_MAX_TIMERS];
 
 void start_thread(int i);
 
@@ -35,15 +39,9 @@ void thread_work(int id)
 {
     while(1)
     {
-        uint32_t remaining_time;
-        flexitimer_get_elapsed(id, &remaining_time);
-
-        if(remaining_time < WATCHDOG_TIMEOUT)
+        if(FLEXITIMER_OK == flexitimer_post_restart(id))
         {
-            if(FLEXITIMER_OK == flexitimer_delay(id, WATCHDOG_TIMEOUT))
-            {
-                printf("Delayed thread %d.\n", id);
-            }
+            printf("Kicked thread %d.\n", id);
         }
 
         sleep((rand() % (WATCHDOG_TIMEOUT * 2)) + 1); // Simulate work
@@ -69,7 +67,7 @@ void watchdog_callback(timer_id_t i)
 void start_thread(int i)
 {
     pthread_create(&threads[i], NULL, (void *(*)(void *))thread_work, (void *)(intptr_t)i);
-    flexitimer_start(i, TIMER_TYPE_SINGLESHOT, WATCHDOG_TIMEOUT, watchdog_callback);
+    flexitimer_post_start(i, TIMER_TYPE_SINGLESHOT, WATCHDOG_TIMEOUT, watchdog_callback); // also called on the workers
     printf("Started thread %d.\n", i);
 }
 
@@ -77,19 +75,21 @@ int main(void)
 {
     srand(time(NULL));
     flexitimer_init();
+    flexitimer_workers_init(&workers, NULL, slots, 2);
 
     for(int i = 0; i < NUM_THREADS; i++)
     {
+        flexitimer_set_dispatch(i, FLEXITIMER_DISPATCH_DEFERRED);
         start_thread(i);
     }
 
-    int i = NUM_THREADS * 10;
-
-    while(i--)
+    /* Kicks are applied when the handler runs, so it is called on every tick rather than at the next deadline */
+    for(int elapsed = 0; elapsed < NUM_THREADS * 10; elapsed++)
     {
+        sleep(1); // 1 tick is 1 second
         flexitimer_handler();
-        sleep(1); // Sleep for 1 second
     }
 
+    flexitimer_workers_deinit(&workers);
     return 0;
 }
@@ -0,0 +1,69 @@
+/**
+    @brief FlexiTimer Scheduler Library
+
+    FlexiTimer is a fast and efficient software timer library designed to work seamlessly across
+    any embedded system, operating system, or bare-metal environment.
+    With MISRA C compliance, it ensures safety and reliability, making it ideal for real-time applications.
+    The timer resolution is flexible and depends on the frequency of the handler function calls,
+    providing high precision for various use cases.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+
+    This example runs a control loop timer on the high-precision tick thread of the Linux driver
+    and prints the measured tick jitter once per second.
+    Usage: tick_jitter [tick_us] [spin_us] [cpu] [fifo_priority] [seconds]
+    e.g. sudo ./tick_jitter 250 20 3 80 10
+*/
+
+#include "flexitimer_linux.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static volatile unsigned long control_runs = 0;
+
+void control_loop(timer_id_t id)
+{
+    control_runs++;
+}
+
+int main(int argc, char *argv[])
+{
+    flexitimer_linux_tick_t tick;
+    flexitimer_linux_tick_config_t config;
+    flexitimer_linux_jitter_t jitter;
+    int seconds = (argc > 5) ? atoi(argv[5]) : 5;
+
+    config.tick_ns = ((argc > 1) ? strtoull(argv[1], NULL, 10) : 500u) * 1000u;
+    config.spin_ns = ((argc > 2) ? strtoull(argv[2], NULL, 10) : 20u) * 1000u;
+    config.cpu = (argc > 3) ? atoi(argv[3]) : -1;
+    config.priority = (argc > 4) ? atoi(argv[4]) : 0;
+
+    flexitimer_init();
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 1, control_loop); // every tick
+
+    if(flexitimer_linux_tick_start(&tick, NULL, &config) != FLEXITIMER_OK)
+    {
+        perror("tick thread"); // SCHED_FIFO needs root or CAP_SYS_NICE
+        return 1;
+    }
+
+    for(int i = 0; i < seconds; i++)
+    {
+        sleep(1);
+        flexitimer_linux_tick_jitter(&tick, &jitter);
+        printf("ticks %llu missed %llu jitter min %llu avg %llu p99 %llu max %llu ns\n",
+               (unsigned long long)jitter.ticks, (unsigned long long)jitter.missed,
+               (unsigned long long)jitter.min_ns, (unsigned long long)jitter.avg_ns,
+               (unsigned long long)jitter.p99_ns, (unsigned long long)jitter.max_ns);
+    }
+
+    flexitimer_linux_tick_stop(&tick);
+    printf("Control loop ran %lu times\n", control_runs);
+    return 0;
+}
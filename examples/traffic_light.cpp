@@ -0,0 +1,62 @@
+/**
+    @brief FlexiTimer Scheduler Library
+
+    FlexiTimer is a fast and efficient software timer library designed to work seamlessly across
+    any embedded system, operating system, or bare-metal environment.
+    With MISRA C compliance, it ensures safety and reliability, making it ideal for real-time applications.
+    The timer resolution is flexible and depends on the frequency of the handler function calls,
+    providing high precision for various use cases.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+
+    This example is traffic_light.c on the header-only C++17 scheduler. The three timers and
+    their callbacks are known at compile time, the counters are bytes and the callbacks are
+    inlined into the tick.
+*/
+
+#include "flexitimer.hpp"
+#include <cstdio>
+#include <unistd.h>
+
+static void light(bool r, bool y, bool g)
+{
+    std::printf("Red :\t%s\n", r ? "on" : "off");
+    std::printf("Yellow :\t%s\n", y ? "on" : "off");
+    std::printf("Green :\t%s\n", g ? "on" : "off");
+    std::printf("--------------\n");
+}
+
+int main()
+{
+    auto lights = flexitimer::make_scheduler<15>(
+        [](auto &scheduler, timer_id_t) // red
+        {
+            light(true, false, false);
+            (void)scheduler.start(1, TIMER_TYPE_SINGLESHOT, 8);
+        },
+        [](auto &scheduler, timer_id_t) // yellow
+        {
+            light(true, true, false);
+            (void)scheduler.start(2, TIMER_TYPE_SINGLESHOT, 2);
+        },
+        [](auto &scheduler, timer_id_t) // green
+        {
+            light(false, false, true);
+            (void)scheduler.start(0, TIMER_TYPE_SINGLESHOT, 15);
+        });
+
+    (void)lights.start(2, TIMER_TYPE_SINGLESHOT, 0); // immediate
+    int i = 100;
+
+    while(i--)
+    {
+        lights.handler();
+        sleep(1); // 1 second
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+    @brief FlexiTimer Scheduler Library
+
+    FlexiTimer is a fast and efficient software timer library designed to work seamlessly across
+    any embedded system, operating system, or bare-metal environment.
+    With MISRA C compliance, it ensures safety and reliability, making it ideal for real-time applications.
+    The timer resolution is flexible and depends on the frequency of the handler function calls,
+    providing high precision for various use cases.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+
+    This example is traffic_light.c as a C++20 coroutine. The light cycle reads top to bottom,
+    each phase waits in a timer slot of the default context and flexitimer_handler() resumes it.
+    A second coroutine power cycles a sensor as industrial_device.c does, off, on and settled.
+*/
+
+#include "flexitimer_coro.hpp"
+#include <cstdio>
+#include <unistd.h>
+
+static void light(bool r, bool y, bool g)
+{
+    std::printf("Red :\t%s\n", r ? "on" : "off");
+    std::printf("Yellow :\t%s\n", y ? "on" : "off");
+    std::printf("Green :\t%s\n", g ? "on" : "off");
+    std::printf("--------------\n");
+}
+
+static flexitimer::task traffic_light()
+{
+    for(;;)
+    {
+        light(false, false, true);
+        (void)co_await flexitimer::sleep_for(15);
+        light(true, false, false);
+        (void)co_await flexitimer::sleep_for(8);
+        light(true, true, false);
+        (void)co_await flexitimer::sleep_for(2);
+    }
+}
+
+static flexitimer::task sensor_power_cycle(int sensor)
+{
+    flexitimer::ticker checks;
+    (void)checks.start(20);
+
+    for(;;)
+    {
+        (void)co_await checks.next();
+        std::printf("Sensor %d powered off\n", sensor);
+        (void)co_await flexitimer::sleep_for(10);
+        std::printf("Sensor %d powered on\n", sensor);
+        (void)co_await flexitimer::sleep_for(3);
+        std::printf("Sensor %d power settled\n", sensor);
+    }
+}
+
+int main()
+{
+    flexitimer_init();
+    (void)flexitimer::coro_slots(0, FLEXITIMER_MAX_TIMERS);
+    flexitimer::task lights = traffic_light();
+    flexitimer::task sensor = sensor_power_cycle(3);
+    int i = 100;
+
+    while(i--)
+    {
+        flexitimer_handler();
+        sleep(1); // 1 second
+    }
+
+    return 0;
+}
@@ -5,9 +5,30 @@ CONFIG -= qt
 
 SOURCES += \
         examples/basic_example.c \
-        src/flexitimer.c
+        src/flexitimer.c \
+        src/flexitimer_scan.c \
+        src/flexitimer_soa.c \
+        src/flexitimer_wheel.c \
+        src/flexitimer_heap.c \
+        src/flexitimer_queue.c \
+        src/flexitimer_pool.c \
+        src/flexitimer_stats.c \
+        src/flexitimer_snapshot.c \
+        src/flexitimer_trace.c \
+        src/flexitimer_group.c \
+        src/flexitimer_linux.c \
+        src/flexitimer_workers.c \
+        src/flexitimer_shards.c \
+        src/flexitimer_static.c
 
 HEADERS += \
-    include/flexitimer.h
+    include/flexitimer.h \
+    include/flexitimer.hpp \
+    include/flexitimer_coro.hpp \
+    include/flexitimer_linux.h \
+    include/flexitimer_workers.h \
+    include/flexitimer_shards.h \
+    include/flexitimer_static.h \
+    src/flexitimer_internal.h
 
 INCLUDEPATH += $$PWD/include
@@ -25,20 +25,217 @@ extern "C" {
 #include <stdint.h>
 
 /**
-    @brief Number of timers
+    @brief Number of timers of the default scheduler instance
 */
+#ifndef FLEXITIMER_MAX_TIMERS
+#define FLEXITIMER_MAX_TIMERS (10)
+#endif
+
+/**
+    @brief Cache line size used to align the scheduler contexts
+*/
+#ifndef FLEXITIMER_CACHE_LINE
+#define FLEXITIMER_CACHE_LINE (64)
+#endif
+
+/**
+    @brief Entries of the per-context command queue used by the flexitimer_post functions,
+    a power of two, 0 leaves the queue out.
+*/
+#ifndef FLEXITIMER_QUEUE_SIZE
+#define FLEXITIMER_QUEUE_SIZE (0)
+#endif
+
+#if (FLEXITIMER_QUEUE_SIZE & (FLEXITIMER_QUEUE_SIZE - 1)) != 0
+#error "FLEXITIMER_QUEUE_SIZE must be a power of two"
+#endif
+
+/**
+    @brief Width of timer_id_t in bits, 8, 16 or 32. Limits the number of timers per context.
+*/
+#ifndef FLEXITIMER_ID_BITS
+#define FLEXITIMER_ID_BITS (8)
+#endif
+
+/**
+    @brief 1 adds the handle API, flexitimer_create() hands out timers from a pool instead of
+    fixed ids.
+*/
+#ifndef FLEXITIMER_HANDLES
+#define FLEXITIMER_HANDLES (0)
+#endif
+
+/**
+    @brief Width of flexitimer_handle_t in bits, 32 or 64.
+    32-bit handles address up to 2^20 timers per context with a 12-bit generation,
+    64-bit handles address up to 2^32 timers with a 32-bit generation.
+*/
+#ifndef FLEXITIMER_HANDLE_BITS
+#define FLEXITIMER_HANDLE_BITS (32)
+#endif
+
+/**
+    @brief 1 adds the slack window of flexitimer_start_ex() to the timer records. 0 leaves it
+    out, the timers then expire on their deadline, which is within any window.
+*/
+#ifndef FLEXITIMER_SLACK
+#define FLEXITIMER_SLACK (0)
+#endif
 
+/**
+    @brief 1 keeps runtime statistics of every timer, see flexitimer_get_stats().
+    0 compiles the instrumentation out.
+*/
+#ifndef FLEXITIMER_STATS
+#define FLEXITIMER_STATS (0)
+#endif
+
+/**
+    @brief Buckets of the callback duration histogram, bucket 0 counts durations of 0 and
+    bucket n durations of 2^(n-1) up to 2^n - 1 clock units, the last one also the longer ones.
+*/
+#ifndef FLEXITIMER_STATS_BUCKETS
+#define FLEXITIMER_STATS_BUCKETS (16)
+#endif
+
+/**
+    @brief Width of the tick counters of a timer record in bits, 8, 16 or 32. Narrow counters
+    shrink the records, timeouts plus slack and delayed remaining times must fit the width.
+*/
+#ifndef FLEXITIMER_COUNTER_BITS
+#define FLEXITIMER_COUNTER_BITS (32)
+#endif
+
+/**
+    @brief 1 stores the callback of a timer as a one byte index into a callback table of the
+    context instead of a function pointer, see flexitimer_set_callbacks().
+*/
+#ifndef FLEXITIMER_CALLBACK_TABLE
+#define FLEXITIMER_CALLBACK_TABLE (0)
+#endif
+
+/**
+    @brief 1 adds the snapshot functions, which read timers from any thread without a lock
+    while the handler thread updates them, see flexitimer_snapshot().
+*/
+#ifndef FLEXITIMER_SNAPSHOT
+#define FLEXITIMER_SNAPSHOT (0)
+#endif
+
+/**
+    @brief 1 adds the event trace, every timer operation, tick and callback of a context is
+    recorded into a ring buffer set with flexitimer_set_trace().
+*/
+#ifndef FLEXITIMER_TRACE
+#define FLEXITIMER_TRACE (0)
+#endif
+
+/**
+    @brief 1 adds timer groups, whole groups of timers are paused, resumed, cancelled and
+    delayed in O(1), see flexitimer_set_groups().
+*/
+#ifndef FLEXITIMER_GROUPS
+#define FLEXITIMER_GROUPS (0)
+#endif
+
+/**
+    @brief 1 adds priority classes and a dispatch budget, the callbacks of a tick run by class
+    and the ones left over when the budget is spent wait for the next handler call, see
+    flexitimer_set_priority() and flexitimer_set_budget().
+*/
+#ifndef FLEXITIMER_PRIORITIES
+#define FLEXITIMER_PRIORITIES (0)
+#endif
+
+#if defined(__GNUC__)
+#define FLEXITIMER_ALIGNED __attribute__((aligned(FLEXITIMER_CACHE_LINE)))
+#else
+#define FLEXITIMER_ALIGNED
+#endif
+
+/**
+    @brief Timer engines, selected at build time with FLEXITIMER_ENGINE.
+
+    SCAN  : walks all timers every tick, smallest footprint.
+    WHEEL : hierarchical timing wheel, O(1) start/cancel/delay and a per-tick cost
+            proportional to the expiring timers only.
+    HEAP  : min-heap of absolute deadlines, O(log n) start/cancel/delay and an O(1)
+            next expiry query.
+*/
+#define FLEXITIMER_ENGINE_SCAN  (0)
+#define FLEXITIMER_ENGINE_WHEEL (1)
+#define FLEXITIMER_ENGINE_HEAP  (2)
+
+#ifndef FLEXITIMER_ENGINE
+#define FLEXITIMER_ENGINE FLEXITIMER_ENGINE_SCAN
+#endif
+
+/**
+    @brief 1 switches the SCAN engine to a structure-of-arrays layout: the remaining ticks of all
+    timers are kept in a dense array of the context next to an active bitmask, and every tick
+    decrements them with an AVX2, SSE2 or scalar kernel. A context then holds at most
+    FLEXITIMER_MAX_TIMERS timers.
+*/
+#ifndef FLEXITIMER_SCAN_SOA
+#define FLEXITIMER_SCAN_SOA (0)
+#endif
+
+/**
+    @brief Words of the active timer bitmap of the SCAN engine, one bit per timer for up to
+    FLEXITIMER_MAX_TIMERS timers. Larger contexts use one bit per block of timers.
+*/
+#define FLEXITIMER_BITMAP_WORDS ((FLEXITIMER_MAX_TIMERS + 63u) / 64u)
 
 /**
     @brief Id unit type
 */
+#if FLEXITIMER_ID_BITS == 8
 typedef uint8_t timer_id_t;
+#elif FLEXITIMER_ID_BITS == 16
+typedef uint16_t timer_id_t;
+#elif FLEXITIMER_ID_BITS == 32
+typedef uint32_t timer_id_t;
+#else
+#error "FLEXITIMER_ID_BITS must be 8, 16 or 32"
+#endif
+
+/**
+    @brief Timer handle type, the timer index and a generation that changes on every reuse.
+    0 is never a valid handle.
+*/
+#if FLEXITIMER_HANDLE_BITS == 32
+typedef uint32_t flexitimer_handle_t;
+#define FLEXITIMER_HANDLE_INDEX_BITS (20u)
+#elif FLEXITIMER_HANDLE_BITS == 64
+typedef uint64_t flexitimer_handle_t;
+#define FLEXITIMER_HANDLE_INDEX_BITS (32u)
+#else
+#error "FLEXITIMER_HANDLE_BITS must be 32 or 64"
+#endif
+
+#define FLEXITIMER_HANDLE_INVALID ((flexitimer_handle_t)0)
 
 /**
     @brief Time unit type
 */
 typedef uint32_t timer_time_t;
 
+/**
+    @brief Tick counter type of the timer records.
+*/
+#if FLEXITIMER_COUNTER_BITS == 8
+typedef uint8_t flexitimer_count_t;
+#define FLEXITIMER_COUNTER_MAX (UINT8_MAX)
+#elif FLEXITIMER_COUNTER_BITS == 16
+typedef uint16_t flexitimer_count_t;
+#define FLEXITIMER_COUNTER_MAX (UINT16_MAX)
+#elif FLEXITIMER_COUNTER_BITS == 32
+typedef uint32_t flexitimer_count_t;
+#define FLEXITIMER_COUNTER_MAX (UINT32_MAX)
+#else
+#error "FLEXITIMER_COUNTER_BITS must be 8, 16 or 32"
+#endif
+
 /**
     @brief Timer callback function type.
 
@@ -65,6 +262,68 @@ typedef enum
     TIMER_STATE_PAUSED
 } timer_state_t;
 
+/**
+    @brief Catch-up policy of a periodic timer whose deadlines passed before the handler ran,
+    i.e. a flexitimer_advance() or flexitimer_poll() covering several periods.
+    ALL      : fires once for every missed period.
+    COALESCE : fires once for all missed periods.
+    SKIP     : drops the missed firings.
+    The deadlines stay on the period grid of the first start with every policy.
+*/
+typedef enum
+{
+    FLEXITIMER_CATCHUP_ALL,
+    FLEXITIMER_CATCHUP_COALESCE,
+    FLEXITIMER_CATCHUP_SKIP
+} flexitimer_catchup_t;
+
+/**
+    @brief Dispatch mode of a timer callback.
+    INLINE   : the handler calls the callback itself.
+    DEFERRED : the handler hands the expiration to the dispatcher of the context, e.g. the
+               worker pool of flexitimer_workers.h, and goes on with the next timer.
+*/
+typedef enum
+{
+    FLEXITIMER_DISPATCH_INLINE,
+    FLEXITIMER_DISPATCH_DEFERRED
+} flexitimer_dispatch_t;
+
+/**
+    @brief Priority class of a timer callback, the classes run in this order.
+    HIGH   : runs in the handler call of its expiry even when the dispatch budget is spent.
+    NORMAL : default class.
+    LOW    : runs after NORMAL.
+    IDLE   : runs last.
+    Within a class the callbacks run in expiry order, those of one tick in ascending id order.
+*/
+typedef enum
+{
+    FLEXITIMER_PRIORITY_HIGH,
+    FLEXITIMER_PRIORITY_NORMAL,
+    FLEXITIMER_PRIORITY_LOW,
+    FLEXITIMER_PRIORITY_IDLE
+} flexitimer_priority_t;
+
+#define FLEXITIMER_PRIORITY_CLASSES (4u)
+
+/**
+    @brief Executor of deferred callbacks. submit is called by the handler for every expiration
+    of a DEFERRED timer, flush once at the end of every flexitimer_handler() or flexitimer_advance()
+    to hand the collected batch over.
+*/
+typedef struct
+{
+    void (*submit)(void *arg, timer_id_t id, timer_callback_t callback);
+    void (*flush)(void *arg);
+    void *arg;
+} flexitimer_dispatcher_t;
+
+/**
+    @brief Monotonic time source, returns the current time in ticks.
+*/
+typedef timer_time_t (*flexitimer_time_source_t)(void);
+
 /**
     @brief Error enumeration for scheduler functions.
 */
@@ -74,9 +333,278 @@ typedef enum
     FLEXITIMER_ERROR_INVALID_ID,
     FLEXITIMER_ERROR_INVALID_STATE,
     FLEXITIMER_ERROR_INVALID_ARG,
-    FLEXITIMER_ERROR_ZERO_TIMEOUT
+    FLEXITIMER_ERROR_ZERO_TIMEOUT,
+    FLEXITIMER_ERROR_FULL,
+    FLEXITIMER_ERROR_SYSTEM
 } flexitimer_error_t;
 
+/**
+    @brief Timing wheel geometry, 6 levels of 64 slots cover the 32-bit timer_time_t range.
+*/
+#define FLEXITIMER_WHEEL_BITS   (6u)
+#define FLEXITIMER_WHEEL_SIZE   (1u << FLEXITIMER_WHEEL_BITS)
+#define FLEXITIMER_WHEEL_LEVELS (6u)
+
+/**
+    @brief Node index type used by the intrusive lists of the engines.
+*/
+typedef uint32_t flexitimer_node_t;
+
+/**
+    @brief List link structure.
+*/
+typedef struct
+{
+    flexitimer_node_t next;
+    flexitimer_node_t prev;
+} flexitimer_link_t;
+
+/**
+    @brief Heap entry structure.
+*/
+typedef struct
+{
+    timer_time_t deadline;
+    timer_id_t id;
+} flexitimer_heap_entry_t;
+
+/**
+    @brief Clock used to time the callbacks, in any monotonic unit (ns, cycles, ...).
+*/
+typedef uint64_t (*flexitimer_clock_t)(void);
+
+/**
+    @brief Runtime statistics of a timer.
+*/
+typedef struct
+{
+    uint32_t fires;         // expirations
+    uint32_t overruns;      // callbacks that ran longer than the overrun limit
+    uint64_t total_time;    // sum of the callback durations, in clock units
+    uint64_t max_time;      // longest callback duration, in clock units
+    uint32_t histogram[FLEXITIMER_STATS_BUCKETS]; // callback durations, log2 buckets
+} flexitimer_stats_t;
+
+/**
+    @brief Timer structure, one per timer in the storage of a scheduler context.
+    Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_count_t timeout;
+    flexitimer_count_t remaining;
+#if FLEXITIMER_SLACK
+    flexitimer_count_t slack;   // ticks the expiry may be deferred by
+    flexitimer_count_t slip;    // ticks the armed expiry lies past the nominal deadline
+#endif
+#if FLEXITIMER_CALLBACK_TABLE
+    uint8_t callback;           // callback table index plus one, 0 for none
+#else
+    timer_callback_t callback;
+#endif
+    uint8_t type : 1;           // timer_type_t
+    uint8_t state : 2;          // timer_state_t
+    uint8_t catchup : 2;        // flexitimer_catchup_t
+    uint8_t dispatch : 1;       // flexitimer_dispatch_t
+#if FLEXITIMER_PRIORITIES
+    uint8_t priority : 2;       // flexitimer_priority_t
+#endif
+#if FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_WHEEL
+    timer_time_t expiry;
+    flexitimer_link_t link;
+#elif FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_HEAP
+    timer_time_t expiry;
+    flexitimer_node_t position;
+    flexitimer_heap_entry_t heap; // heap slot with the same index, not this timer's entry
+#endif
+#if FLEXITIMER_HANDLES
+    uint32_t generation; // odd while allocated
+    flexitimer_node_t next_free;
+#endif
+#if FLEXITIMER_STATS
+    flexitimer_stats_t stats;
+#endif
+#if FLEXITIMER_PRIORITIES
+    flexitimer_node_t pending_next; // next timer in the dispatch queue of the class
+    timer_time_t pending_since;     // tick of the expiry waiting for its callback
+    uint8_t pending;                // queued and live flags
+#endif
+#if FLEXITIMER_GROUPS
+    timer_time_t group_lag;     // lag of the group clock the armed expiry accounts for
+    uint32_t group_epoch;       // cancels of the group before the start
+    uint8_t group;              // group index plus one, 0 for none
+#endif
+} flexitimer_timer_t;
+
+/**
+    @brief Timer group structure, one per group in the storage set with flexitimer_set_groups().
+    The group clock runs behind the ticks of the context by its delays and pauses, the timers
+    of the group expire on the group clock. Its members are private to the library.
+*/
+typedef struct
+{
+    timer_time_t lag;       // delays plus the ticks of the ended pauses
+    timer_time_t paused_at; // tick of the running pause
+    uint32_t epoch;         // cancels so far
+    uint8_t paused;
+} flexitimer_group_t;
+
+/**
+    @brief Dispatch statistics of a priority class, see flexitimer_get_class_stats().
+*/
+typedef struct
+{
+    uint32_t dispatched;    // callbacks run
+    uint32_t carried;       // callbacks run in a later handler call than their expiry
+    uint32_t coalesced;     // expiries of a timer whose previous expiry still waited, run as one
+    timer_time_t max_wait;  // most ticks a callback ran after its expiry
+    uint32_t waiting;       // expiries waiting now
+    timer_time_t oldest;    // ticks the oldest waiting expiry waited so far
+} flexitimer_class_stats_t;
+
+/**
+    @brief Dispatch queue of a priority class.
+*/
+typedef struct
+{
+    flexitimer_node_t head;
+    flexitimer_node_t tail;
+    flexitimer_class_stats_t stats; // without waiting and oldest, counted on request
+} flexitimer_class_t;
+
+/**
+    @brief Trace event types.
+    TICK_BEGIN/END : a flexitimer_handler() or flexitimer_advance() call, the value is the ticks.
+    FIRE_BEGIN/END : a callback, or its hand-over to the dispatcher of a DEFERRED timer.
+    GROUP_* : the successful group operations, the id is the group, the value of GROUP_DELAY
+    the delay.
+    HANDLE_CREATE/DESTROY : a pooled timer is allocated or returned, the value is the generation
+    of its handle.
+    The other types are the successful timer operations, the value of START is the timeout
+    and the one of DELAY the delay.
+*/
+typedef enum
+{
+    FLEXITIMER_TRACE_START,
+    FLEXITIMER_TRACE_DELAY,
+    FLEXITIMER_TRACE_PAUSE,
+    FLEXITIMER_TRACE_RESUME,
+    FLEXITIMER_TRACE_RESTART,
+    FLEXITIMER_TRACE_CANCEL,
+    FLEXITIMER_TRACE_FIRE_BEGIN,
+    FLEXITIMER_TRACE_FIRE_END,
+    FLEXITIMER_TRACE_TICK_BEGIN,
+    FLEXITIMER_TRACE_TICK_END,
+    FLEXITIMER_TRACE_GROUP_PAUSE,
+    FLEXITIMER_TRACE_GROUP_RESUME,
+    FLEXITIMER_TRACE_GROUP_CANCEL,
+    FLEXITIMER_TRACE_GROUP_DELAY,
+    FLEXITIMER_TRACE_HANDLE_CREATE,
+    FLEXITIMER_TRACE_HANDLE_DESTROY
+} flexitimer_trace_type_t;
+
+/**
+    @brief Trace event, 24 bytes.
+*/
+typedef struct
+{
+    uint64_t clock;         // trace clock reading, 0 without a clock
+    timer_time_t tick;      // ticks processed by the context so far
+    uint32_t id;            // timer identifier, 0 for ticks
+    timer_time_t value;
+    uint8_t type;           // flexitimer_trace_type_t
+} flexitimer_trace_event_t;
+
+/**
+    @brief Consistent copy of the public state of a timer, see flexitimer_snapshot().
+*/
+typedef struct
+{
+    timer_state_t state;
+    timer_type_t type;
+    timer_time_t timeout;   // original timeout, see flexitimer_get_time()
+    timer_time_t remaining; // remaining time, see flexitimer_get_elapsed()
+} flexitimer_snapshot_t;
+
+/**
+    @brief Command queue entry structure.
+*/
+typedef struct
+{
+    uint32_t sequence;
+    uint8_t op;
+    timer_type_t type;
+    timer_id_t id;
+    timer_time_t value;
+    timer_callback_t callback;
+} flexitimer_command_t;
+
+/**
+    @brief Scheduler context structure, an independent scheduler instance.
+    Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_timer_t *timers;
+    uint32_t capacity;
+    timer_time_t now;
+    timer_time_t target; // tick the running handler or advance catches up to
+    flexitimer_time_source_t time_source;
+    timer_time_t source_time; // time source reading of the last poll
+    flexitimer_dispatcher_t dispatcher;
+#if FLEXITIMER_CALLBACK_TABLE
+    const timer_callback_t *callbacks;
+    uint32_t callback_count;
+#endif
+#if (FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_SCAN) && FLEXITIMER_SCAN_SOA
+    timer_time_t lanes[FLEXITIMER_BITMAP_WORDS * 64u] FLEXITIMER_ALIGNED; // remaining ticks, by id
+    uint64_t active[FLEXITIMER_BITMAP_WORDS];
+    uint64_t pending[FLEXITIMER_BITMAP_WORDS]; // expired on the tick being processed
+#elif FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_SCAN
+    uint64_t active[FLEXITIMER_BITMAP_WORDS]; // blocks with armed timers
+    uint32_t block_shift; // log2 of the timers per bitmap bit
+#elif FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_WHEEL
+    flexitimer_link_t heads[(FLEXITIMER_WHEEL_LEVELS * FLEXITIMER_WHEEL_SIZE) + 1u];
+#elif FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_HEAP
+    flexitimer_node_t count;
+    uint8_t batch; // 1 while a bulk operation leaves the heap unordered
+#endif
+#if FLEXITIMER_HANDLES
+    flexitimer_node_t free_head;
+#endif
+#if FLEXITIMER_STATS
+    flexitimer_clock_t clock;
+    uint64_t overrun_limit;
+#endif
+#if FLEXITIMER_TRACE
+    flexitimer_trace_event_t *trace;
+    uint32_t trace_mask;
+    uint32_t trace_head; // events recorded so far
+    flexitimer_clock_t trace_clock;
+#endif
+#if FLEXITIMER_GROUPS
+    flexitimer_group_t *groups;
+    uint32_t group_count;
+#endif
+#if FLEXITIMER_PRIORITIES
+    flexitimer_class_t classes[FLEXITIMER_PRIORITY_CLASSES];
+    uint32_t budget_callbacks; // callbacks per handler call, 0 for no limit
+    uint64_t budget_time;      // clock units per handler call, 0 for no limit
+    flexitimer_clock_t budget_clock;
+    uint32_t budget_used;      // callbacks of the running handler call
+    uint64_t budget_start;     // clock reading at the start of the running handler call
+#endif
+#if FLEXITIMER_SNAPSHOT
+    uint32_t write_depth; // nesting of the update sections of the handler thread
+    uint32_t sequence FLEXITIMER_ALIGNED; // odd during an update, readers on their own cache line
+#endif
+#if FLEXITIMER_QUEUE_SIZE > 0
+    uint32_t queue_head;
+    uint32_t queue_tail FLEXITIMER_ALIGNED; // producers on their own cache line
+    flexitimer_command_t queue[FLEXITIMER_QUEUE_SIZE] FLEXITIMER_ALIGNED;
+#endif
+} FLEXITIMER_ALIGNED flexitimer_ctx_t;
+
 /**
     @brief Initializes the scheduler.
 */
@@ -88,20 +616,67 @@ void flexitimer_init(void);
     @param type Timer type (singleshot or periodic).
     @param timeout Timeout value in milliseconds.
     @param callback Callback function to be called when the timer expires.
-    @return Error code.
+    @return Error code, FLEXITIMER_ERROR_INVALID_ARG if the timeout exceeds the counter width
+    or the callback is missing from the callback table.
 */
 flexitimer_error_t flexitimer_start(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
 
+/**
+    @brief Starts a timer that may expire up to slack ticks after its deadline.
+    The expiry is moved inside [deadline, deadline + slack] to the tick with the coarsest
+    alignment, so timers with overlapping windows expire on the same tick and the scheduler
+    wakes up once for them. Periodic timers keep their deadlines on the period grid.
+    Without FLEXITIMER_SLACK the slack is only checked and the timer expires on its deadline.
+    @param id Timer identifier.
+    @param type Timer type (singleshot or periodic).
+    @param timeout Timeout value in milliseconds.
+    @param slack Tolerated lateness in ticks, less than the timeout for periodic timers.
+    @param callback Callback function to be called when the timer expires.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_start_ex(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_time_t slack, timer_callback_t callback);
+
 /**
     @brief Handler function to be called in a loop.
 */
 void flexitimer_handler(void);
 
+/**
+    @brief Processes the given number of elapsed ticks at once.
+    Gives the same callbacks, in the same order, as calling flexitimer_handler() that many times,
+    but the cost does not grow with the ticks. With the WHEEL and HEAP engines it is
+    proportional to the expirations, the WHEEL engine adding one step per higher level wheel
+    slot it cascades on the way. The SCAN engine looks at every active timer once per
+    expiry, so its cost is the expirations times the active timers.
+    @param ticks Number of elapsed ticks.
+*/
+void flexitimer_advance(timer_time_t ticks);
+
+/**
+    @brief Gets the number of ticks until the earliest active timer expires.
+    Lets a tickless loop sleep until the next deadline instead of waking up on every tick.
+    Timers of a group that was delayed or paused since they were armed may come up earlier
+    than they expire, the handler then only re-arms them. The members of a cancelled group
+    stay armed until their old deadline and may come up the same way, except with the HEAP
+    engine, which drops them here. Callbacks left over by the dispatch budget make it 1.
+    @param ticks Pointer to store the number of handler calls until the next expiry (at least 1).
+    @return Error code, FLEXITIMER_ERROR_INVALID_STATE if no timer is active.
+*/
+flexitimer_error_t flexitimer_next_expiry(timer_time_t *ticks);
+
+/**
+    @brief Gets the number of ticks processed since the initialization, wrapping around.
+    A callback reads the tick its timer expired on.
+    @param now Pointer to store the tick count.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_get_now(timer_time_t *now);
+
 /**
     @brief Postpones / Delays the specified timer.
     @param id Timer identifier.
     @param delay Delay value to be added to the timeout.
-    @return Error code.
+    @return Error code, FLEXITIMER_ERROR_INVALID_ARG if the remaining time would exceed the counter width.
 */
 flexitimer_error_t flexitimer_delay(timer_id_t id, timer_time_t delay);
 
@@ -165,6 +740,523 @@ flexitimer_error_t flexitimer_get_time(timer_id_t id, timer_time_t *time);
 */
 flexitimer_error_t flexitimer_get_elapsed(timer_id_t id, timer_time_t *time);
 
+/**
+    @brief Starts several timers with the same parameters, see flexitimer_start().
+    The ids and parameters are validated once for all timers, nothing is started if one of
+    them is invalid. The engine indexes are updated in one pass, the heap engine rebuilds its
+    heap once for a batch of at least an eighth of the active timers.
+    @param ids Timer identifiers, NULL for the timers 0 to count - 1.
+    @param count Number of timers.
+    @param type Timer type.
+    @param timeout Timeout value in ticks.
+    @param callback Callback function.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_start_many(const timer_id_t *ids, uint32_t count, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+
+/**
+    @brief Cancels several timers, see flexitimer_cancel() and flexitimer_start_many().
+    @param ids Timer identifiers, NULL for the timers 0 to count - 1.
+    @param count Number of timers.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_cancel_many(const timer_id_t *ids, uint32_t count);
+
+/**
+    @brief Delays several timers by the same number of ticks, see flexitimer_delay().
+    Nothing is delayed if an id is invalid or a remaining time would exceed the counter width,
+    a repeated id is delayed and checked once per occurrence.
+    @param ids Timer identifiers, NULL for the timers 0 to count - 1.
+    @param count Number of timers.
+    @param delay Delay value in ticks.
+    @return Error code, FLEXITIMER_ERROR_INVALID_STATE if some of the timers were passive,
+    the others are delayed.
+*/
+flexitimer_error_t flexitimer_delay_many(const timer_id_t *ids, uint32_t count, timer_time_t delay);
+
+/**
+    @brief Gets the states and remaining times of several timers.
+    @param ids Timer identifiers, NULL for the timers 0 to count - 1.
+    @param count Number of timers.
+    @param states Pointer to store count states, NULL if not needed.
+    @param remaining Pointer to store count remaining times, NULL if not needed.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_query_many(const timer_id_t *ids, uint32_t count, timer_state_t *states, timer_time_t *remaining);
+
+/**
+    @brief Sets the catch-up policy of the specified timer, FLEXITIMER_CATCHUP_ALL by default.
+    The policy is kept when the timer is started again.
+    @param id Timer identifier.
+    @param policy Catch-up policy.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_catchup(timer_id_t id, flexitimer_catchup_t policy);
+
+/**
+    @brief Sets the dispatch mode of the specified timer, FLEXITIMER_DISPATCH_INLINE by default.
+    DEFERRED timers run inline while no dispatcher is set. The mode is kept when the timer is
+    started again.
+    @param id Timer identifier.
+    @param mode Dispatch mode.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_dispatch(timer_id_t id, flexitimer_dispatch_t mode);
+
+/**
+    @brief Sets the executor of the DEFERRED timers.
+    @param dispatcher Dispatcher, copied, NULL runs all callbacks inline.
+*/
+void flexitimer_set_dispatcher(const flexitimer_dispatcher_t *dispatcher);
+
+#if FLEXITIMER_CALLBACK_TABLE
+/**
+    @brief Sets the callbacks the timers may use, the records store their table index.
+    Call it after flexitimer_init() and before starting timers.
+    @param callbacks Callback table, up to 255 entries, must stay valid while timers use it.
+    @param count Number of entries.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_callbacks(const timer_callback_t *callbacks, uint32_t count);
+#endif
+
+/**
+    @brief Sets the monotonic time source that drives flexitimer_poll().
+    @param source Time source, returns the current time in ticks.
+*/
+void flexitimer_set_time_source(flexitimer_time_source_t source);
+
+/**
+    @brief Processes the ticks elapsed on the time source since the previous poll.
+    Replaces flexitimer_handler() in loops that do not run exactly once per tick: the deadlines
+    follow the time source, so late or irregular polls do not make periodic timers drift.
+*/
+void flexitimer_poll(void);
+
+/**
+    @brief Initializes a scheduler context.
+    Every context is independent, the functions above operate on a default context of
+    FLEXITIMER_MAX_TIMERS timers. A context must only be used by one thread at a time.
+    @param ctx Context to initialize.
+    @param storage Timer storage of the context, must stay valid while the context is used.
+    @param capacity Number of timers in the storage, the timer ids are 0 to capacity - 1.
+    When handles are enabled, every timer starts out in the free pool of flexitimer_ctx_create().
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_ctx_init(flexitimer_ctx_t *ctx, flexitimer_timer_t *storage, uint32_t capacity);
+
+/**
+    @brief Starts a timer of a context, see flexitimer_start().
+*/
+flexitimer_error_t flexitimer_ctx_start(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+
+/**
+    @brief Starts a timer of a context with a slack window, see flexitimer_start_ex().
+*/
+flexitimer_error_t flexitimer_ctx_start_ex(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_time_t slack, timer_callback_t callback);
+
+/**
+    @brief Handler function of a context, see flexitimer_handler().
+*/
+void flexitimer_ctx_handler(flexitimer_ctx_t *ctx);
+
+/**
+    @brief Processes elapsed ticks of a context, see flexitimer_advance().
+*/
+void flexitimer_ctx_advance(flexitimer_ctx_t *ctx, timer_time_t ticks);
+
+/**
+    @brief Gets the ticks until the next expiry of a context, see flexitimer_next_expiry().
+*/
+flexitimer_error_t flexitimer_ctx_next_expiry(flexitimer_ctx_t *ctx, timer_time_t *ticks);
+
+/**
+    @brief Gets the ticks processed by a context, see flexitimer_get_now().
+*/
+flexitimer_error_t flexitimer_ctx_get_now(const flexitimer_ctx_t *ctx, timer_time_t *now);
+
+/**
+    @brief Delays a timer of a context, see flexitimer_delay().
+*/
+flexitimer_error_t flexitimer_ctx_delay(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t delay);
+
+/**
+    @brief Pauses a timer of a context, see flexitimer_pause().
+*/
+flexitimer_error_t flexitimer_ctx_pause(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Resumes a timer of a context, see flexitimer_resume().
+*/
+flexitimer_error_t flexitimer_ctx_resume(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Restarts a timer of a context, see flexitimer_restart().
+*/
+flexitimer_error_t flexitimer_ctx_restart(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Cancels a timer of a context, see flexitimer_cancel().
+*/
+flexitimer_error_t flexitimer_ctx_cancel(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Gets the state of a timer of a context, see flexitimer_get_state().
+*/
+flexitimer_error_t flexitimer_ctx_get_state(flexitimer_ctx_t *ctx, timer_id_t id, timer_state_t *state);
+
+/**
+    @brief Gets the type of a timer of a context, see flexitimer_get_type().
+*/
+flexitimer_error_t flexitimer_ctx_get_type(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t *type);
+
+/**
+    @brief Gets the original timeout of a timer of a context, see flexitimer_get_time().
+*/
+flexitimer_error_t flexitimer_ctx_get_time(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t *time);
+
+/**
+    @brief Gets the remaining time of a timer of a context, see flexitimer_get_elapsed().
+*/
+flexitimer_error_t flexitimer_ctx_get_elapsed(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t *time);
+
+/**
+    @brief Bulk operations on the timers of a context, see flexitimer_start_many().
+*/
+flexitimer_error_t flexitimer_ctx_start_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_ctx_cancel_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count);
+flexitimer_error_t flexitimer_ctx_delay_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_time_t delay);
+flexitimer_error_t flexitimer_ctx_query_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_state_t *states, timer_time_t *remaining);
+
+/**
+    @brief Sets the catch-up policy of a timer of a context, see flexitimer_set_catchup().
+*/
+flexitimer_error_t flexitimer_ctx_set_catchup(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_catchup_t policy);
+
+/**
+    @brief Sets the dispatch mode of a timer of a context, see flexitimer_set_dispatch().
+*/
+flexitimer_error_t flexitimer_ctx_set_dispatch(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_dispatch_t mode);
+
+/**
+    @brief Sets the dispatcher of a context, see flexitimer_set_dispatcher().
+*/
+void flexitimer_ctx_set_dispatcher(flexitimer_ctx_t *ctx, const flexitimer_dispatcher_t *dispatcher);
+
+#if FLEXITIMER_CALLBACK_TABLE
+/**
+    @brief Sets the callback table of a context, see flexitimer_set_callbacks().
+*/
+flexitimer_error_t flexitimer_ctx_set_callbacks(flexitimer_ctx_t *ctx, const timer_callback_t *callbacks, uint32_t count);
+#endif
+
+/**
+    @brief Sets the time source of a context, see flexitimer_set_time_source().
+*/
+void flexitimer_ctx_set_time_source(flexitimer_ctx_t *ctx, flexitimer_time_source_t source);
+
+/**
+    @brief Polls the time source of a context, see flexitimer_poll().
+*/
+void flexitimer_ctx_poll(flexitimer_ctx_t *ctx);
+
+#if FLEXITIMER_QUEUE_SIZE > 0
+
+/**
+    @brief Thread-safe variants of the timer operations.
+    They can be called from any thread, without locks, and queue the operation on a bounded
+    multi-producer single-consumer queue of the context. The handler thread applies the queued
+    operations in order at the start of the next flexitimer_handler(), flexitimer_advance() or
+    flexitimer_next_expiry() call. The id and the timeout are validated when posting, errors
+    that depend on the timer state at that time are not reported.
+    @return Error code, FLEXITIMER_ERROR_FULL if the queue is full.
+*/
+flexitimer_error_t flexitimer_post_start(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_post_delay(timer_id_t id, timer_time_t delay);
+flexitimer_error_t flexitimer_post_pause(timer_id_t id);
+flexitimer_error_t flexitimer_post_resume(timer_id_t id);
+flexitimer_error_t flexitimer_post_restart(timer_id_t id);
+flexitimer_error_t flexitimer_post_cancel(timer_id_t id);
+
+/**
+    @brief Thread-safe operations on a timer of a context, see flexitimer_post_start().
+*/
+flexitimer_error_t flexitimer_ctx_post_start(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_ctx_post_delay(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t delay);
+flexitimer_error_t flexitimer_ctx_post_pause(flexitimer_ctx_t *ctx, timer_id_t id);
+flexitimer_error_t flexitimer_ctx_post_resume(flexitimer_ctx_t *ctx, timer_id_t id);
+flexitimer_error_t flexitimer_ctx_post_restart(flexitimer_ctx_t *ctx, timer_id_t id);
+flexitimer_error_t flexitimer_ctx_post_cancel(flexitimer_ctx_t *ctx, timer_id_t id);
+
+#endif // FLEXITIMER_QUEUE_SIZE
+
+#if FLEXITIMER_SNAPSHOT
+
+/**
+    @brief Reads the state, type, timeout and remaining time of a timer from any thread.
+    Lock-free: the handler thread marks its updates with a sequence counter and never waits
+    for readers, a read that overlaps an update is repeated. Callbacks run outside the updates.
+    @param id Timer identifier.
+    @param snapshot Pointer to store the copy.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_snapshot(timer_id_t id, flexitimer_snapshot_t *snapshot);
+
+/**
+    @brief Reads timers 0 to count - 1 at once, the copies show all timers at the same point
+    between two updates of the handler thread.
+    @param snapshots Pointer to store count copies, indexed by id.
+    @param count Number of timers to copy.
+    @return Error code, FLEXITIMER_ERROR_INVALID_ID if count exceeds the capacity of the context.
+*/
+flexitimer_error_t flexitimer_snapshot_all(flexitimer_snapshot_t *snapshots, uint32_t count);
+
+/**
+    @brief Snapshot functions of a context, see flexitimer_snapshot().
+*/
+flexitimer_error_t flexitimer_ctx_snapshot(const flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_snapshot_t *snapshot);
+flexitimer_error_t flexitimer_ctx_snapshot_all(const flexitimer_ctx_t *ctx, flexitimer_snapshot_t *snapshots, uint32_t count);
+
+#endif // FLEXITIMER_SNAPSHOT
+
+#if FLEXITIMER_TRACE
+
+/**
+    @brief Starts recording the events of the default context into a ring buffer, the newest
+    events overwrite the oldest ones. Recording an event takes a few stores and a clock call.
+    @param buffer Event storage, NULL stops the recording.
+    @param count Number of events in the buffer, a power of two.
+    @param clock Clock of the event timestamps, in any monotonic unit, NULL for none.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_trace(flexitimer_trace_event_t *buffer, uint32_t count, flexitimer_clock_t clock);
+
+/**
+    @brief Copies the latest recorded events, oldest first. Lock-free, can be called from any
+    thread while the context runs. Events overwritten during the copy are left out, and so is
+    the oldest event of a full buffer, which the next event replaces.
+    @param events Pointer to store the events.
+    @param count Maximum number of events to copy.
+    @return Number of events copied.
+*/
+uint32_t flexitimer_trace_read(flexitimer_trace_event_t *events, uint32_t count);
+
+/**
+    @brief Trace functions of a context, see flexitimer_set_trace().
+*/
+flexitimer_error_t flexitimer_ctx_set_trace(flexitimer_ctx_t *ctx, flexitimer_trace_event_t *buffer, uint32_t count, flexitimer_clock_t clock);
+uint32_t flexitimer_ctx_trace_read(const flexitimer_ctx_t *ctx, flexitimer_trace_event_t *events, uint32_t count);
+
+#endif // FLEXITIMER_TRACE
+
+#if FLEXITIMER_GROUPS
+
+/**
+    @brief Sets the timer groups of the default context, to be called before grouped timers
+    are started. The groups are reset and every timer leaves its group.
+    @param groups Group storage, NULL for no groups.
+    @param count Number of groups, up to 255.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_groups(flexitimer_group_t *groups, uint32_t count);
+
+/**
+    @brief Starts a timer as a member of a group, see flexitimer_start(). The timer stays in
+    the group until it is started again. A timer started in a paused group waits for the resume
+    of the group.
+    @param id Timer identifier.
+    @param group Group index.
+    @param type Timer type (singleshot or periodic).
+    @param timeout Timeout value in ticks.
+    @param callback Callback function.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_start_in_group(timer_id_t id, uint32_t group, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+
+/**
+    @brief Pauses all timers of a group in O(1), the active members report PAUSED until the
+    group is resumed and cannot be paused or resumed on their own meanwhile.
+    @param group Group index.
+    @return Error code, FLEXITIMER_ERROR_INVALID_STATE if the group is paused already.
+*/
+flexitimer_error_t flexitimer_group_pause(uint32_t group);
+
+/**
+    @brief Resumes all timers of a paused group in O(1), they expire as late as the pause lasted.
+    @param group Group index.
+    @return Error code, FLEXITIMER_ERROR_INVALID_STATE if the group is not paused.
+*/
+flexitimer_error_t flexitimer_group_resume(uint32_t group);
+
+/**
+    @brief Cancels all timers of a group in O(1), see flexitimer_cancel(). The group itself
+    stays usable, timers started in it afterwards are not affected.
+    @param group Group index.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_group_cancel(uint32_t group);
+
+/**
+    @brief Delays all active timers of a group in O(1), see flexitimer_delay(). Members paused
+    on their own keep their remaining time.
+    @param group Group index.
+    @param delay Delay value in ticks.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_group_delay(uint32_t group, timer_time_t delay);
+
+/**
+    @brief Group functions of a context, see flexitimer_set_groups().
+*/
+flexitimer_error_t flexitimer_ctx_set_groups(flexitimer_ctx_t *ctx, flexitimer_group_t *groups, uint32_t count);
+flexitimer_error_t flexitimer_ctx_start_in_group(flexitimer_ctx_t *ctx, timer_id_t id, uint32_t group, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_ctx_group_pause(flexitimer_ctx_t *ctx, uint32_t group);
+flexitimer_error_t flexitimer_ctx_group_resume(flexitimer_ctx_t *ctx, uint32_t group);
+flexitimer_error_t flexitimer_ctx_group_cancel(flexitimer_ctx_t *ctx, uint32_t group);
+flexitimer_error_t flexitimer_ctx_group_delay(flexitimer_ctx_t *ctx, uint32_t group, timer_time_t delay);
+
+#endif // FLEXITIMER_GROUPS
+
+#if FLEXITIMER_PRIORITIES
+
+/**
+    @brief Sets the priority class of the specified timer, FLEXITIMER_PRIORITY_NORMAL by default.
+    The class is kept when the timer is started again. A callback waiting for dispatch moves
+    to the end of the queue of the new class.
+    @param id Timer identifier.
+    @param priority Priority class.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_priority(timer_id_t id, flexitimer_priority_t priority);
+
+/**
+    @brief Limits the callbacks of each flexitimer_handler(), flexitimer_advance() or
+    flexitimer_poll() call. Once the budget is spent only HIGH callbacks run, the others wait
+    in their class for the next call. A timer expiring again while its callback waits gets one
+    callback for both expiries.
+    @param callbacks Callbacks per call, 0 for no limit.
+    @param time Clock units per call, 0 for no limit. A callback that starts within the
+    budget runs to its end.
+    @param clock Clock measuring the time budget, NULL for none.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_set_budget(uint32_t callbacks, uint64_t time, flexitimer_clock_t clock);
+
+/**
+    @brief Gets the dispatch statistics of a priority class, counted since the initialization
+    or the last reset. The waiting expiries are counted on request.
+    @param priority Priority class.
+    @param stats Pointer to store the statistics.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_get_class_stats(flexitimer_priority_t priority, flexitimer_class_stats_t *stats);
+
+/**
+    @brief Resets the dispatch statistics of all priority classes.
+*/
+void flexitimer_reset_class_stats(void);
+
+/**
+    @brief Priority functions of a context, see flexitimer_set_budget().
+*/
+flexitimer_error_t flexitimer_ctx_set_priority(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_priority_t priority);
+flexitimer_error_t flexitimer_ctx_set_budget(flexitimer_ctx_t *ctx, uint32_t callbacks, uint64_t time, flexitimer_clock_t clock);
+flexitimer_error_t flexitimer_ctx_get_class_stats(const flexitimer_ctx_t *ctx, flexitimer_priority_t priority, flexitimer_class_stats_t *stats);
+void flexitimer_ctx_reset_class_stats(flexitimer_ctx_t *ctx);
+
+#endif // FLEXITIMER_PRIORITIES
+
+#if FLEXITIMER_HANDLES
+
+/**
+    @brief Allocates a timer from the pool of the default context.
+    Allocation and release are O(1), the free timers are chained through their records.
+    The allocated timer is PASSIVE until it is started.
+    @param handle Pointer to store the handle of the timer.
+    @return Error code, FLEXITIMER_ERROR_FULL if every timer is allocated.
+*/
+flexitimer_error_t flexitimer_create(flexitimer_handle_t *handle);
+
+/**
+    @brief Cancels a timer and returns it to the pool.
+    The handle and every copy of it become stale, later calls with them fail with
+    FLEXITIMER_ERROR_INVALID_ID even after the timer is allocated again.
+    @param handle Timer handle.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_destroy(flexitimer_handle_t handle);
+
+/**
+    @brief Gets the timer id of a handle, the id passed to the callback and used by the id based functions.
+    @param handle Timer handle.
+    @param id Pointer to store the timer id.
+    @return Error code, FLEXITIMER_ERROR_INVALID_ID if the handle is stale.
+*/
+flexitimer_error_t flexitimer_handle_id(flexitimer_handle_t handle, timer_id_t *id);
+
+/**
+    @brief Timer operations by handle, see the id based functions.
+    @return Error code, FLEXITIMER_ERROR_INVALID_ID if the handle is stale.
+*/
+flexitimer_error_t flexitimer_handle_start(flexitimer_handle_t handle, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_handle_delay(flexitimer_handle_t handle, timer_time_t delay);
+flexitimer_error_t flexitimer_handle_pause(flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_handle_resume(flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_handle_restart(flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_handle_cancel(flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_handle_get_state(flexitimer_handle_t handle, timer_state_t *state);
+flexitimer_error_t flexitimer_handle_get_elapsed(flexitimer_handle_t handle, timer_time_t *time);
+
+/**
+    @brief Handle functions of a context, see flexitimer_create().
+    Contexts used with handles are limited to 2^FLEXITIMER_HANDLE_INDEX_BITS timers.
+*/
+flexitimer_error_t flexitimer_ctx_create(flexitimer_ctx_t *ctx, flexitimer_handle_t *handle);
+flexitimer_error_t flexitimer_ctx_destroy(flexitimer_ctx_t *ctx, flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_ctx_handle_id(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_id_t *id);
+flexitimer_error_t flexitimer_ctx_handle_start(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_ctx_handle_delay(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_time_t delay);
+flexitimer_error_t flexitimer_ctx_handle_pause(flexitimer_ctx_t *ctx, flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_ctx_handle_resume(flexitimer_ctx_t *ctx, flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_ctx_handle_restart(flexitimer_ctx_t *ctx, flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_ctx_handle_cancel(flexitimer_ctx_t *ctx, flexitimer_handle_t handle);
+flexitimer_error_t flexitimer_ctx_handle_get_state(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_state_t *state);
+flexitimer_error_t flexitimer_ctx_handle_get_elapsed(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_time_t *time);
+
+#endif // FLEXITIMER_HANDLES
+
+#if FLEXITIMER_STATS
+
+/**
+    @brief Sets the clock that times the callbacks of the default context.
+    Without a clock the fires are counted but every callback takes 0 time.
+    @param clock Clock function, NULL to stop timing.
+    @param overrun_limit Callback duration above which a fire counts as an overrun, in clock units.
+*/
+void flexitimer_set_clock(flexitimer_clock_t clock, uint64_t overrun_limit);
+
+/**
+    @brief Gets the runtime statistics of the specified timer.
+    @param id Timer identifier.
+    @param stats Pointer to store the statistics.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_get_stats(timer_id_t id, flexitimer_stats_t *stats);
+
+/**
+    @brief Clears the runtime statistics of all timers.
+*/
+void flexitimer_reset_stats(void);
+
+/**
+    @brief Statistics functions of a context, see flexitimer_get_stats().
+*/
+void flexitimer_ctx_set_clock(flexitimer_ctx_t *ctx, flexitimer_clock_t clock, uint64_t overrun_limit);
+flexitimer_error_t flexitimer_ctx_get_stats(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_stats_t *stats);
+void flexitimer_ctx_reset_stats(flexitimer_ctx_t *ctx);
+
+#endif // FLEXITIMER_STATS
+
 #ifdef __cplusplus
 }
 #endif
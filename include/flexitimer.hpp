@@ -0,0 +1,449 @@
+/**
+    @file flexitimer.hpp
+    @brief FlexiTimer Scheduler Library - compile-time specialized C++17 scheduler
+
+    Header-only scheduler for small fixed timer sets. The storage is an array of Capacity
+    records sized at compile time, the counters use TimeT, usually counter_t<MaxTimeout>, the
+    narrowest unsigned type that holds the longest timeout. Expired timers call the Policy,
+    a callable known at compile time, with the id as a std::integral_constant, so the tick is
+    unrolled over the ids and a Callbacks policy inlines the callable of each id at its place.
+
+    The semantics are those of the C API with the SCAN engine and the default timer options,
+    built without FLEXITIMER_PRIORITIES: a timer started with timeout T expires after max(T, 1)
+    ticks, the timers expiring on the same tick call back in ascending id order, a periodic
+    timer is re-armed before its callback and the functions return the same error codes. With
+    priorities the C callbacks run after the tick, so a timer started from the callback of a
+    lower id is counted down one tick later there. Slack, catch-up policies, deferred dispatch
+    and the command queue are left to the C contexts.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_HPP
+#define FLEXITIMER_HPP
+
+#include "flexitimer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace flexitimer
+{
+
+/**
+    @brief Narrowest unsigned counter type that holds the given maximum timeout.
+*/
+template <timer_time_t MaxTimeout>
+using counter_t = std::conditional_t<(MaxTimeout <= UINT8_MAX), std::uint8_t,
+                  std::conditional_t<(MaxTimeout <= UINT16_MAX), std::uint16_t, timer_time_t>>;
+
+/**
+    @brief Timer identifier passed to the callbacks, converts to timer_id_t.
+*/
+template <timer_id_t Id>
+using timer_id = std::integral_constant<timer_id_t, Id>;
+
+/**
+    @brief Policy calling one callable per timer, the callable of timer i is the i-th one.
+    A callable takes (Scheduler &, timer_id_t) or (timer_id_t), a timer_callback_t also fits.
+    Timers without a callable expire silently, as with a NULL callback.
+*/
+template <typename... Fn>
+class Callbacks
+{
+public:
+    constexpr explicit Callbacks(Fn... fn) : fn_(std::move(fn)...)
+    {
+    }
+
+    template <typename Scheduler, timer_id_t Id>
+    constexpr void operator()(Scheduler &scheduler, timer_id<Id> id)
+    {
+        if constexpr(Id < sizeof...(Fn))
+        {
+            auto &fn = std::get<Id>(fn_);
+
+            if constexpr(std::is_invocable_v<decltype(fn), Scheduler &, timer_id_t>)
+            {
+                fn(scheduler, id);
+            }
+            else
+            {
+                fn(id);
+            }
+        }
+    }
+
+private:
+    std::tuple<Fn...> fn_;
+};
+
+/**
+    @brief Scheduler with compile-time capacity, counter type and callback policy.
+    @tparam Capacity Number of timers, ids 0 to Capacity - 1.
+    @tparam TimeT Unsigned counter type, see counter_t.
+    @tparam Policy Callable invoked with (Scheduler &, timer_id<Id>) or (timer_id<Id>) on expiry.
+*/
+template <std::size_t Capacity, typename TimeT, typename Policy>
+class Scheduler
+{
+    static_assert(Capacity > 0u, "a scheduler needs at least one timer");
+    static_assert(Capacity - 1u <= std::numeric_limits<timer_id_t>::max(), "Capacity exceeds timer_id_t, raise FLEXITIMER_ID_BITS");
+    static_assert(std::is_unsigned_v<TimeT> && (sizeof(TimeT) <= sizeof(timer_time_t)), "TimeT must be an unsigned type up to timer_time_t");
+
+public:
+    using time_type = TimeT;
+    static constexpr std::size_t capacity = Capacity;
+
+    constexpr explicit Scheduler(Policy policy = Policy()) : timers_{}, policy_(std::move(policy))
+    {
+    }
+
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    /**
+        @brief Resets all timers to passive, see flexitimer_ctx_init().
+    */
+    constexpr void init()
+    {
+        timers_ = {};
+    }
+
+    /**
+        @brief Starts a timer, see flexitimer_start(). The callback is the one of the policy.
+    */
+    constexpr flexitimer_error_t start(timer_id_t id, timer_type_t type, TimeT timeout)
+    {
+        if(id >= Capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+
+        if(type == TIMER_TYPE_PERIODIC && timeout == 0u)
+        {
+            return FLEXITIMER_ERROR_ZERO_TIMEOUT;
+        }
+
+        Timer &timer = timers_[id];
+        timer.timeout = timeout;
+        timer.remaining = timeout;
+        timer.type = static_cast<std::uint8_t>(type);
+        timer.state = static_cast<std::uint8_t>(TIMER_STATE_ACTIVE);
+        timer.bound = 1u;
+        return FLEXITIMER_OK;
+    }
+
+    /**
+        @brief Processes one tick, see flexitimer_handler().
+    */
+    constexpr void handler()
+    {
+        tick(std::make_index_sequence<Capacity>());
+    }
+
+    /**
+        @brief Processes several elapsed ticks at once, see flexitimer_advance().
+    */
+    constexpr void advance(timer_time_t ticks)
+    {
+        while(ticks > 0u)
+        {
+            /* Callbacks may arm earlier timers, so the next expiry is looked up after every tick */
+            timer_time_t next = this->next();
+
+            if((next == 0u) || (next > ticks))
+            {
+                skip(ticks);
+                break;
+            }
+
+            skip(next - 1u);
+            handler();
+            ticks -= next;
+        }
+    }
+
+    /**
+        @brief Gets the ticks until the earliest expiry, see flexitimer_next_expiry().
+    */
+    constexpr flexitimer_error_t next_expiry(timer_time_t *ticks) const
+    {
+        if(ticks == nullptr)
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+
+        *ticks = next();
+        return (*ticks > 0u) ? FLEXITIMER_OK : FLEXITIMER_ERROR_INVALID_STATE;
+    }
+
+    /**
+        @brief Delays a timer, see flexitimer_delay().
+        @return FLEXITIMER_ERROR_INVALID_ARG if the remaining time would overflow TimeT.
+    */
+    constexpr flexitimer_error_t delay(timer_id_t id, TimeT delay)
+    {
+        if(id >= Capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+
+        Timer &timer = timers_[id];
+
+        if((timer.state != TIMER_STATE_ACTIVE) && (timer.state != TIMER_STATE_PAUSED))
+        {
+            return FLEXITIMER_ERROR_INVALID_STATE;
+        }
+
+        if(delay > (std::numeric_limits<TimeT>::max() - timer.remaining))
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+
+        timer.remaining = static_cast<TimeT>(timer.remaining + delay);
+        return FLEXITIMER_OK;
+    }
+
+    /**
+        @brief Pauses a timer, see flexitimer_pause().
+    */
+    constexpr flexitimer_error_t pause(timer_id_t id)
+    {
+        return transition(id, TIMER_STATE_ACTIVE, TIMER_STATE_PAUSED);
+    }
+
+    /**
+        @brief Resumes a timer, see flexitimer_resume().
+    */
+    constexpr flexitimer_error_t resume(timer_id_t id)
+    {
+        return transition(id, TIMER_STATE_PAUSED, TIMER_STATE_ACTIVE);
+    }
+
+    /**
+        @brief Restarts a timer with its original timeout, see flexitimer_restart().
+    */
+    constexpr flexitimer_error_t restart(timer_id_t id)
+    {
+        if(id >= Capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+
+        Timer &timer = timers_[id];
+
+        if(timer.bound == 0u)
+        {
+            return FLEXITIMER_ERROR_INVALID_STATE;
+        }
+
+        timer.remaining = timer.timeout;
+        timer.state = static_cast<std::uint8_t>(TIMER_STATE_ACTIVE);
+        return FLEXITIMER_OK;
+    }
+
+    /**
+        @brief Cancels a timer, see flexitimer_cancel(). It cannot be restarted afterwards.
+    */
+    constexpr flexitimer_error_t cancel(timer_id_t id)
+    {
+        if(id >= Capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+
+        Timer &timer = timers_[id];
+        timer.state = static_cast<std::uint8_t>(TIMER_STATE_PASSIVE);
+        timer.remaining = 0u;
+        timer.bound = 0u;
+        return FLEXITIMER_OK;
+    }
+
+    /**
+        @brief Timer queries, see flexitimer_get_state(), flexitimer_get_type(),
+        flexitimer_get_time() and flexitimer_get_elapsed().
+    */
+    constexpr flexitimer_error_t get_state(timer_id_t id, timer_state_t *state) const
+    {
+        return get(id, state, static_cast<timer_state_t>(timers_[index(id)].state));
+    }
+
+    constexpr flexitimer_error_t get_type(timer_id_t id, timer_type_t *type) const
+    {
+        return get(id, type, static_cast<timer_type_t>(timers_[index(id)].type));
+    }
+
+    constexpr flexitimer_error_t get_time(timer_id_t id, timer_time_t *time) const
+    {
+        return get(id, time, static_cast<timer_time_t>(timers_[index(id)].timeout));
+    }
+
+    constexpr flexitimer_error_t get_elapsed(timer_id_t id, timer_time_t *time) const
+    {
+        return get(id, time, static_cast<timer_time_t>(timers_[index(id)].remaining));
+    }
+
+    /**
+        @brief Gets the callback policy.
+    */
+    constexpr Policy &policy()
+    {
+        return policy_;
+    }
+
+private:
+    struct Timer
+    {
+        TimeT timeout;
+        TimeT remaining;
+        std::uint8_t type;
+        std::uint8_t state;
+        std::uint8_t bound;     // started and not cancelled, the C API checks the callback instead
+    };
+
+    /* Counts down one timer and expires it, the id is a constant of the unrolled tick */
+    template <timer_id_t Id>
+    constexpr void tick_one()
+    {
+        Timer &timer = timers_[Id];
+
+        if(timer.state == TIMER_STATE_ACTIVE)
+        {
+            if(timer.remaining > 0u)
+            {
+                timer.remaining--;
+            }
+
+            if(timer.remaining == 0u)
+            {
+                if(timer.type == TIMER_TYPE_PERIODIC)
+                {
+                    timer.remaining = timer.timeout;
+                }
+                else
+                {
+                    timer.state = static_cast<std::uint8_t>(TIMER_STATE_PASSIVE);
+                }
+
+                if(timer.bound != 0u)
+                {
+                    if constexpr(std::is_invocable_v<Policy &, Scheduler &, timer_id<Id>>)
+                    {
+                        policy_(*this, timer_id<Id>());
+                    }
+                    else
+                    {
+                        policy_(timer_id<Id>());
+                    }
+                }
+            }
+        }
+    }
+
+    /* Ticks the timers in ascending id order */
+    template <std::size_t... Id>
+    constexpr void tick(std::index_sequence<Id...>)
+    {
+        (tick_one<static_cast<timer_id_t>(Id)>(), ...);
+    }
+
+    /* Gets the ticks until the earliest expiry, 0 if no timer is active */
+    constexpr timer_time_t next() const
+    {
+        timer_time_t next = 0u;
+
+        for(const Timer &timer : timers_)
+        {
+            if(timer.state == TIMER_STATE_ACTIVE)
+            {
+                timer_time_t ticks = (timer.remaining > 0u) ? timer.remaining : 1u;
+
+                if((next == 0u) || (ticks < next))
+                {
+                    next = ticks;
+                }
+            }
+        }
+
+        return next;
+    }
+
+    /* Skips ticks without expiries */
+    constexpr void skip(timer_time_t ticks)
+    {
+        for(Timer &timer : timers_)
+        {
+            if(timer.state == TIMER_STATE_ACTIVE)
+            {
+                timer.remaining = static_cast<TimeT>(timer.remaining - ticks);
+            }
+        }
+    }
+
+    /* Moves a timer from one state to another */
+    constexpr flexitimer_error_t transition(timer_id_t id, timer_state_t from, timer_state_t to)
+    {
+        if(id >= Capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+
+        if(timers_[id].state != from)
+        {
+            return FLEXITIMER_ERROR_INVALID_STATE;
+        }
+
+        timers_[id].state = static_cast<std::uint8_t>(to);
+        return FLEXITIMER_OK;
+    }
+
+    /* Clamps an id for the queries, which check it afterwards */
+    static constexpr std::size_t index(timer_id_t id)
+    {
+        return (id < Capacity) ? id : 0u;
+    }
+
+    /* Stores a queried value */
+    template <typename T>
+    constexpr flexitimer_error_t get(timer_id_t id, T *out, T value) const
+    {
+        if(id >= Capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+
+        if(out == nullptr)
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+
+        *out = value;
+        return FLEXITIMER_OK;
+    }
+
+    std::array<Timer, Capacity> timers_;
+    Policy policy_;
+};
+
+/**
+    @brief Makes a scheduler with one timer per callable, see Callbacks.
+    @tparam MaxTimeout Longest timeout, selects the counter type.
+*/
+template <timer_time_t MaxTimeout, typename... Fn>
+constexpr Scheduler<sizeof...(Fn), counter_t<MaxTimeout>, Callbacks<Fn...>> make_scheduler(Fn... fn)
+{
+    return Scheduler<sizeof...(Fn), counter_t<MaxTimeout>, Callbacks<Fn...>>(Callbacks<Fn...>(std::move(fn)...));
+}
+
+} // namespace flexitimer
+
+#endif // FLEXITIMER_HPP
@@ -0,0 +1,422 @@
+/**
+    @file flexitimer_coro.hpp
+    @brief FlexiTimer Scheduler Library - C++20 coroutine awaitables
+
+    Lets a coroutine wait for ticks of the default context, so a sequence of timed steps is
+    written top to bottom instead of as callbacks re-arming each other. A range of timer ids
+    is lent to the waits with coro_slots(). A suspended coroutine is parked in the slot of the
+    timer it waits for and resumed from its callback, inside flexitimer_handler(),
+    flexitimer_advance() or flexitimer_poll(), on the thread calling them. Waiting takes no
+    thread and allocates nothing besides the coroutine frame.
+
+    Every co_await returns the error code of the C API, a wait that cannot be started returns
+    right away instead of suspending: FLEXITIMER_ERROR_FULL if all slots are taken. A wait that
+    is destroyed with its coroutine cancels its timer and frees its slot. With
+    FLEXITIMER_CALLBACK_TABLE the callback table has to contain resume_slot().
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_CORO_HPP
+#define FLEXITIMER_CORO_HPP
+
+#include "flexitimer.h"
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+
+namespace flexitimer
+{
+
+namespace detail
+{
+
+/* Wait slot of one timer id */
+struct Slot
+{
+    std::coroutine_handle<> waiter; // parked coroutine, empty if none
+    std::uint32_t expiries;         // ticker expiries nobody waited for
+    bool used;
+};
+
+inline std::array<Slot, FLEXITIMER_MAX_TIMERS> slots{};
+inline std::uint32_t slot_first = 0u;
+inline std::uint32_t slot_count = 0u;
+
+/* Takes a free slot, FLEXITIMER_MAX_TIMERS if there is none */
+inline std::uint32_t claim_slot()
+{
+    for(std::uint32_t i = slot_first; i < (slot_first + slot_count); i++)
+    {
+        if(!slots[i].used)
+        {
+            slots[i] = Slot{{}, 0u, true};
+            return i;
+        }
+    }
+
+    return FLEXITIMER_MAX_TIMERS;
+}
+
+/* Cancels the timer of a slot and frees it */
+inline void release_slot(std::uint32_t id)
+{
+    (void)flexitimer_cancel(static_cast<timer_id_t>(id));
+    slots[id] = Slot{};
+}
+
+} // namespace detail
+
+/**
+    @brief Lends the timer ids first to first + count - 1 of the default context to the
+    coroutine waits, at most one wait or ticker per id. Call it after flexitimer_init(),
+    slots still in use keep their timers.
+    @return FLEXITIMER_ERROR_INVALID_ID if the range exceeds FLEXITIMER_MAX_TIMERS.
+*/
+inline flexitimer_error_t coro_slots(timer_id_t first, std::uint32_t count)
+{
+    if((first > FLEXITIMER_MAX_TIMERS) || (count > (static_cast<std::uint32_t>(FLEXITIMER_MAX_TIMERS) - first)))
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    detail::slot_first = first;
+    detail::slot_count = count;
+    return FLEXITIMER_OK;
+}
+
+/**
+    @brief Timer callback of the waits, resumes the coroutine parked on the timer.
+*/
+inline void resume_slot(timer_id_t id)
+{
+    detail::Slot &slot = detail::slots[id];
+
+    if(!slot.waiter)
+    {
+        slot.expiries++; // a ticker running ahead of its coroutine
+        return;
+    }
+
+    std::coroutine_handle<> waiter = slot.waiter;
+    slot.waiter = nullptr;
+    waiter.resume();
+}
+
+/**
+    @brief Coroutine return type that starts running at once and is destroyed with the task,
+    along with the wait it is parked in.
+*/
+class task
+{
+public:
+    struct promise_type
+    {
+        task get_return_object()
+        {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+    task(task &&other) noexcept : handle_(other.handle_)
+    {
+        other.handle_ = nullptr;
+    }
+
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+
+    task &operator=(task &&other) noexcept
+    {
+        if(this != &other)
+        {
+            destroy();
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+
+        return *this;
+    }
+
+    ~task()
+    {
+        destroy();
+    }
+
+    /**
+        @brief Checks whether the coroutine ran to its end.
+    */
+    bool done() const
+    {
+        return !handle_ || handle_.done();
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) : handle_(handle)
+    {
+    }
+
+    void destroy()
+    {
+        if(handle_)
+        {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+    @brief Awaitable of sleep_for() and until(), a single-shot timer in a free slot.
+*/
+class sleep_awaiter
+{
+public:
+    explicit sleep_awaiter(timer_time_t ticks) : ticks_(ticks)
+    {
+    }
+
+    sleep_awaiter(const sleep_awaiter &) = delete;
+    sleep_awaiter &operator=(const sleep_awaiter &) = delete;
+
+    ~sleep_awaiter()
+    {
+        /* Still parked, the coroutine is destroyed while waiting */
+        if((id_ < FLEXITIMER_MAX_TIMERS) && (detail::slots[id_].waiter == waiter_))
+        {
+            detail::release_slot(id_);
+        }
+    }
+
+    bool await_ready() const noexcept
+    {
+        return ticks_ == 0u;
+    }
+
+    bool await_suspend(std::coroutine_handle<> waiter)
+    {
+        std::uint32_t id = detail::claim_slot();
+
+        if(id >= FLEXITIMER_MAX_TIMERS)
+        {
+            error_ = FLEXITIMER_ERROR_FULL;
+            return false;
+        }
+
+        error_ = flexitimer_start(static_cast<timer_id_t>(id), TIMER_TYPE_SINGLESHOT, ticks_, resume_slot);
+
+        if(error_ != FLEXITIMER_OK)
+        {
+            detail::slots[id] = detail::Slot{};
+            return false;
+        }
+
+        detail::slots[id].waiter = waiter;
+        id_ = id;
+        waiter_ = waiter;
+        return true;
+    }
+
+    flexitimer_error_t await_resume()
+    {
+        if((id_ < FLEXITIMER_MAX_TIMERS) && !detail::slots[id_].waiter)
+        {
+            detail::slots[id_] = detail::Slot{}; // the timer expired, the slot is free again
+            id_ = FLEXITIMER_MAX_TIMERS;
+        }
+
+        return error_;
+    }
+
+private:
+    timer_time_t ticks_;
+    std::uint32_t id_ = FLEXITIMER_MAX_TIMERS;
+    std::coroutine_handle<> waiter_;
+    flexitimer_error_t error_ = FLEXITIMER_OK;
+};
+
+/**
+    @brief Suspends the coroutine for the given ticks, resuming after as many handler calls
+    as a single-shot timer of that timeout. 0 does not suspend.
+*/
+inline sleep_awaiter sleep_for(timer_time_t ticks)
+{
+    return sleep_awaiter(ticks);
+}
+
+/**
+    @brief Suspends the coroutine until the tick count of flexitimer_get_now() reaches the
+    deadline. A deadline that has passed, up to half the tick range ago, does not suspend.
+*/
+inline sleep_awaiter until(timer_time_t deadline)
+{
+    timer_time_t now = 0u;
+    (void)flexitimer_get_now(&now);
+    timer_time_t ticks = deadline - now;
+    return sleep_awaiter((ticks < 0x80000000u) ? ticks : 0u);
+}
+
+/**
+    @brief Periodic timer in a slot of its own, its coroutine waits for each expiry with
+    co_await next(). Expiries while the coroutine is busy are kept and make the following
+    next() calls return at once, one per expiry.
+*/
+class ticker
+{
+public:
+    class next_awaiter
+    {
+    public:
+        explicit next_awaiter(ticker &owner) : owner_(owner)
+        {
+        }
+
+        next_awaiter(const next_awaiter &) = delete;
+        next_awaiter &operator=(const next_awaiter &) = delete;
+
+        ~next_awaiter()
+        {
+            /* Still parked, the coroutine is destroyed while waiting */
+            if(waiter_ && (owner_.id_ < FLEXITIMER_MAX_TIMERS) && (detail::slots[owner_.id_].waiter == waiter_))
+            {
+                detail::slots[owner_.id_].waiter = nullptr;
+            }
+        }
+
+        bool await_ready()
+        {
+            if(owner_.id_ >= FLEXITIMER_MAX_TIMERS)
+            {
+                error_ = FLEXITIMER_ERROR_INVALID_STATE;
+                return true;
+            }
+
+            detail::Slot &slot = detail::slots[owner_.id_];
+
+            if(slot.waiter)
+            {
+                error_ = FLEXITIMER_ERROR_INVALID_STATE; // another coroutine waits already
+                return true;
+            }
+
+            if(slot.expiries > 0u)
+            {
+                slot.expiries--;
+                return true;
+            }
+
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> waiter)
+        {
+            detail::slots[owner_.id_].waiter = waiter;
+            waiter_ = waiter;
+        }
+
+        flexitimer_error_t await_resume() const
+        {
+            return error_;
+        }
+
+    private:
+        ticker &owner_;
+        std::coroutine_handle<> waiter_;
+        flexitimer_error_t error_ = FLEXITIMER_OK;
+    };
+
+    ticker() = default;
+    ticker(const ticker &) = delete;
+    ticker &operator=(const ticker &) = delete;
+
+    ~ticker()
+    {
+        stop();
+    }
+
+    /**
+        @brief Starts ticking with the given period, see flexitimer_start().
+        @return FLEXITIMER_ERROR_FULL if all slots are taken, FLEXITIMER_ERROR_INVALID_STATE
+        if the ticker runs already.
+    */
+    flexitimer_error_t start(timer_time_t period)
+    {
+        if(id_ < FLEXITIMER_MAX_TIMERS)
+        {
+            return FLEXITIMER_ERROR_INVALID_STATE;
+        }
+
+        std::uint32_t id = detail::claim_slot();
+
+        if(id >= FLEXITIMER_MAX_TIMERS)
+        {
+            return FLEXITIMER_ERROR_FULL;
+        }
+
+        flexitimer_error_t error = flexitimer_start(static_cast<timer_id_t>(id), TIMER_TYPE_PERIODIC, period, resume_slot);
+
+        if(error != FLEXITIMER_OK)
+        {
+            detail::slots[id] = detail::Slot{};
+            return error;
+        }
+
+        id_ = id;
+        return FLEXITIMER_OK;
+    }
+
+    /**
+        @brief Stops ticking and frees the slot. A coroutine waiting in next() stays suspended.
+    */
+    void stop()
+    {
+        if(id_ < FLEXITIMER_MAX_TIMERS)
+        {
+            detail::release_slot(id_);
+            id_ = FLEXITIMER_MAX_TIMERS;
+        }
+    }
+
+    /**
+        @brief Waits for the next expiry.
+        @return Awaitable returning FLEXITIMER_ERROR_INVALID_STATE if the ticker is stopped or
+        another coroutine waits on it.
+    */
+    next_awaiter next()
+    {
+        return next_awaiter(*this);
+    }
+
+private:
+    std::uint32_t id_ = FLEXITIMER_MAX_TIMERS;
+};
+
+} // namespace flexitimer
+
+#endif // FLEXITIMER_CORO_HPP
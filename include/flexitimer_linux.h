@@ -0,0 +1,182 @@
+/**
+    @file flexitimer_linux.h
+    @brief FlexiTimer Scheduler Library - Linux timerfd driver
+
+    Runs a scheduler context from a timerfd armed for its next deadline instead of a periodic
+    tick. The descriptor can be added to an existing epoll or poll loop; when it becomes
+    readable, flexitimer_linux_dispatch() processes the ticks elapsed on CLOCK_MONOTONIC and
+    arms the timerfd for the following deadline. No wakeup happens while no timer is due.
+
+    The tick thread is the alternative for short ticks: it calls the handler on an absolute
+    CLOCK_MONOTONIC schedule and measures its own jitter.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_LINUX_H
+#define FLEXITIMER_LINUX_H
+
+#include "flexitimer.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+    @brief Linux driver structure. Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_ctx_t *ctx;
+    int fd;             // timerfd, CLOCK_MONOTONIC, non-blocking
+    uint64_t tick_ns;   // length of a tick
+    uint64_t origin_ns; // CLOCK_MONOTONIC time of tick 0
+    uint64_t ticks;     // ticks processed since the origin
+    uint8_t running;    // cleared by flexitimer_linux_stop()
+    uint8_t wakeup;     // set by flexitimer_linux_wakeup() until the next dispatch
+} flexitimer_linux_t;
+
+/**
+    @brief Initializes a driver and creates its timerfd.
+    @param driver Driver to initialize.
+    @param ctx Scheduler context to run, NULL for the default context.
+    @param tick_ns Length of a tick in nanoseconds.
+    @return Error code, FLEXITIMER_ERROR_SYSTEM with errno set if the timerfd cannot be created.
+*/
+flexitimer_error_t flexitimer_linux_init(flexitimer_linux_t *driver, flexitimer_ctx_t *ctx, uint64_t tick_ns);
+
+/**
+    @brief Closes the timerfd of a driver.
+    @param driver Driver.
+*/
+void flexitimer_linux_deinit(flexitimer_linux_t *driver);
+
+/**
+    @brief Gets the file descriptor to watch for EPOLLIN / POLLIN.
+    @param driver Driver.
+    @return Timerfd, -1 if the driver is not initialized.
+*/
+int flexitimer_linux_fd(const flexitimer_linux_t *driver);
+
+/**
+    @brief Processes the elapsed ticks and arms the timerfd for the next deadline.
+    To be called from the loop when the descriptor is readable.
+    @param driver Driver.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_linux_dispatch(flexitimer_linux_t *driver);
+
+/**
+    @brief Arms the timerfd for the next deadline, to be called on the loop thread after timers
+    were started outside of the callbacks. Changes made by the callbacks are picked up by
+    flexitimer_linux_dispatch().
+    @param driver Driver.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_linux_rearm(flexitimer_linux_t *driver);
+
+/**
+    @brief Makes the descriptor readable at once, so the loop thread dispatches and re-arms.
+    Safe to call from any thread, e.g. after flexitimer_post_start().
+    @param driver Driver.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_linux_wakeup(flexitimer_linux_t *driver);
+
+/**
+    @brief Runs the scheduler on the calling thread until flexitimer_linux_stop() is called.
+    @param driver Driver.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_linux_run(flexitimer_linux_t *driver);
+
+/**
+    @brief Makes flexitimer_linux_run() return, safe to call from any thread or callback.
+    @param driver Driver.
+*/
+void flexitimer_linux_stop(flexitimer_linux_t *driver);
+
+/**
+    @brief Buckets of the tick jitter histogram, 8 per power of two of nanoseconds.
+*/
+#define FLEXITIMER_LINUX_JITTER_BUCKETS (496u)
+
+/**
+    @brief Tick thread configuration.
+*/
+typedef struct
+{
+    uint64_t tick_ns;   // length of a tick
+    uint64_t spin_ns;   // busy-wait window before each deadline, 0 sleeps until the deadline
+    int cpu;            // CPU the thread is pinned to, -1 for no affinity
+    int priority;       // SCHED_FIFO priority, 0 keeps the default scheduling policy
+} flexitimer_linux_tick_config_t;
+
+/**
+    @brief Tick jitter report, the lateness of the handler calls behind their deadlines.
+*/
+typedef struct
+{
+    uint64_t ticks;     // handler calls measured
+    uint64_t missed;    // ticks processed late in a batch after an overrun
+    uint64_t min_ns;
+    uint64_t avg_ns;
+    uint64_t p99_ns;    // upper bound of the 99th percentile histogram bucket
+    uint64_t max_ns;
+} flexitimer_linux_jitter_t;
+
+/**
+    @brief Tick thread structure. Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_ctx_t *ctx;
+    flexitimer_linux_tick_config_t config;
+    pthread_t thread;
+    uint8_t running;
+    uint64_t ticks;
+    uint64_t missed;
+    uint64_t sum_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint32_t histogram[FLEXITIMER_LINUX_JITTER_BUCKETS];
+} flexitimer_linux_tick_t;
+
+/**
+    @brief Starts a thread that calls the handler of a context once per tick, on an absolute
+    CLOCK_MONOTONIC schedule with clock_nanosleep(TIMER_ABSTIME). The last spin_ns before each
+    deadline are busy-waited. Ticks missed after an overrun are processed in one
+    flexitimer_ctx_advance() and the schedule continues without drift. Other threads must use
+    the flexitimer_post functions on the context while the thread runs.
+    @param tick Tick thread.
+    @param ctx Scheduler context to run, NULL for the default context.
+    @param config Configuration.
+    @return Error code, FLEXITIMER_ERROR_SYSTEM with errno set if the thread cannot be created,
+    e.g. without the privilege for SCHED_FIFO.
+*/
+flexitimer_error_t flexitimer_linux_tick_start(flexitimer_linux_tick_t *tick, flexitimer_ctx_t *ctx, const flexitimer_linux_tick_config_t *config);
+
+/**
+    @brief Stops the tick thread and waits for it to exit.
+    @param tick Tick thread.
+*/
+void flexitimer_linux_tick_stop(flexitimer_linux_tick_t *tick);
+
+/**
+    @brief Gets the tick jitter measured so far, also while the thread runs.
+    @param tick Tick thread.
+    @param jitter Report.
+    @return Error code.
+*/
+flexitimer_error_t flexitimer_linux_tick_jitter(const flexitimer_linux_tick_t *tick, flexitimer_linux_jitter_t *jitter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLEXITIMER_LINUX_H
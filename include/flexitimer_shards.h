@@ -0,0 +1,179 @@
+/**
+    @file flexitimer_shards.h
+    @brief FlexiTimer Scheduler Library - sharded per-core schedulers (Linux)
+
+    Spreads the timers over one scheduler context per core, each ticked by its own thread on
+    a common CLOCK_MONOTONIC schedule. A timer is addressed by a key, the shard is the key
+    modulo the shard count and the timer id within the shard the key divided by it. Starts
+    and cancels are posted lock-free to the command queue of the owning shard, so threads that
+    use the keys of their own shard (flexitimer_shards_local()) share no cache line with the
+    other cores. Expired callbacks are queued per shard and run by the shard thread; idle
+    shard threads steal callbacks from busy ones. A callback never runs concurrently with itself.
+
+    Requires the command queue, FLEXITIMER_QUEUE_SIZE > 0.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_SHARDS_H
+#define FLEXITIMER_SHARDS_H
+
+#include "flexitimer.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+    @brief Maximum number of shards.
+*/
+#ifndef FLEXITIMER_SHARDS_MAX
+#define FLEXITIMER_SHARDS_MAX (64)
+#endif
+
+/**
+    @brief Entries of the expired callback queue of a shard, a power of two. Callbacks that do
+    not fit run at once on the shard thread.
+*/
+#ifndef FLEXITIMER_SHARD_JOBS
+#define FLEXITIMER_SHARD_JOBS (256)
+#endif
+
+#if (FLEXITIMER_SHARD_JOBS & (FLEXITIMER_SHARD_JOBS - 1)) != 0
+#error "FLEXITIMER_SHARD_JOBS must be a power of two"
+#endif
+
+/**
+    @brief Ordering of the expirations of the same tick across shards.
+    FREE     : every shard ticks on its own, a slow shard does not hold up the others.
+    LOCKSTEP : tick t+1 starts on no shard before all callbacks of tick t, including the
+               stolen ones, have completed on every shard.
+*/
+typedef enum
+{
+    FLEXITIMER_SHARDS_FREE,
+    FLEXITIMER_SHARDS_LOCKSTEP
+} flexitimer_shards_order_t;
+
+/**
+    @brief Sharded scheduler configuration.
+*/
+typedef struct
+{
+    uint64_t tick_ns;   // length of a tick
+    uint64_t idle_ns;   // longest sleep of an idle shard thread before it looks for commands and work
+    flexitimer_shards_order_t order;
+    int cpu;            // CPU of shard 0, shard i is pinned to CPU cpu + i, -1 for no affinity
+} flexitimer_shards_config_t;
+
+/**
+    @brief Expired callback of a shard.
+*/
+typedef struct
+{
+    timer_id_t id;
+    timer_callback_t callback;
+} flexitimer_shard_job_t;
+
+/**
+    @brief Shard structure, one per core. Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_ctx_t ctx;
+    pthread_t thread;
+    pthread_mutex_t lock;   // guards the jobs
+    uint32_t job_head;
+    uint32_t job_tail;
+    flexitimer_shard_job_t jobs[FLEXITIMER_SHARD_JOBS];
+    uint64_t running;       // shard and id of the callback the thread runs, under the lock of that shard
+    uint64_t stolen;        // callbacks of other shards run by this thread
+    void *owner;
+} flexitimer_shard_t;
+
+/**
+    @brief Sharded scheduler structure. Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_shard_t *shards;
+    uint32_t count;
+    flexitimer_shards_config_t config;
+    uint64_t origin_ns;
+    uint8_t started;        // 1 once all threads exist, 2 if one could not be created
+    uint8_t running;
+    uint8_t proceed;        // LOCKSTEP: decision of the last round
+    uint32_t pending;       // LOCKSTEP: callbacks queued and not completed
+    pthread_barrier_t barrier;
+} flexitimer_shards_t;
+
+/**
+    @brief Initializes the shards and starts their threads.
+    @param sharded Sharded scheduler.
+    @param shards Shard storage, count entries.
+    @param count Number of shards, 1 to FLEXITIMER_SHARDS_MAX, usually the number of cores.
+    @param storage Timer storage, count * timers entries, shard i uses timers [i * timers, (i + 1) * timers).
+    @param timers Timers per shard.
+    @param config Configuration.
+    @return Error code, FLEXITIMER_ERROR_SYSTEM with errno set if a thread cannot be created.
+*/
+flexitimer_error_t flexitimer_shards_init(flexitimer_shards_t *sharded, flexitimer_shard_t *shards, uint32_t count,
+                                          flexitimer_timer_t *storage, uint32_t timers, const flexitimer_shards_config_t *config);
+
+/**
+    @brief Stops the shard threads after the queued callbacks have run.
+    @param sharded Sharded scheduler.
+*/
+void flexitimer_shards_deinit(flexitimer_shards_t *sharded);
+
+/**
+    @brief Gets the shard of the calling thread's CPU.
+    @param sharded Sharded scheduler.
+    @return Shard index.
+*/
+uint32_t flexitimer_shards_local(const flexitimer_shards_t *sharded);
+
+/**
+    @brief Gets the key of a timer of a shard.
+    @param sharded Sharded scheduler.
+    @param shard Shard index.
+    @param id Timer identifier within the shard.
+    @return Timer key.
+*/
+uint32_t flexitimer_shards_key(const flexitimer_shards_t *sharded, uint32_t shard, timer_id_t id);
+
+/**
+    @brief Gets the key of the timer whose callback is running on the calling thread.
+    @param sharded Sharded scheduler.
+    @param id Identifier passed to the callback.
+    @return Timer key.
+*/
+uint32_t flexitimer_shards_callback_key(const flexitimer_shards_t *sharded, timer_id_t id);
+
+/**
+    @brief Thread-safe timer operations by key, see flexitimer_post_start().
+    The operation is applied by the shard thread.
+*/
+flexitimer_error_t flexitimer_shards_start(flexitimer_shards_t *sharded, uint32_t key, timer_type_t type, timer_time_t timeout, timer_callback_t callback);
+flexitimer_error_t flexitimer_shards_delay(flexitimer_shards_t *sharded, uint32_t key, timer_time_t delay);
+flexitimer_error_t flexitimer_shards_restart(flexitimer_shards_t *sharded, uint32_t key);
+flexitimer_error_t flexitimer_shards_cancel(flexitimer_shards_t *sharded, uint32_t key);
+
+/**
+    @brief Gets the number of callbacks a shard thread ran for other shards.
+    @param sharded Sharded scheduler.
+    @param shard Shard index.
+    @return Stolen callbacks.
+*/
+uint64_t flexitimer_shards_stolen(const flexitimer_shards_t *sharded, uint32_t shard);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLEXITIMER_SHARDS_H
@@ -0,0 +1,125 @@
+/**
+    @file flexitimer_static.h
+    @brief FlexiTimer Scheduler Library - compile-time static timer tables
+
+    A static table declares a fixed set of timers at compile time. The configuration of each
+    timer, its id, type, period, initial phase and callback, is a const entry that the linker
+    places in read-only memory. Only a counter and a flags byte per timer sit in RAM, zeroed at
+    startup like any other static variable, so the timers run from the first handler call
+    without an initialization call.
+
+    A timer first expires after its phase, or after its period if the phase is 0, and then
+    every period. Phases spread the expiries of timers with the same period over different
+    ticks. Timers expiring on the same tick call back in table order.
+
+    FLEXITIMER_STATIC_TABLE(sensors,
+        FLEXITIMER_STATIC_TIMER(0, TIMER_TYPE_PERIODIC, 10, 1, read_sensor),
+        FLEXITIMER_STATIC_TIMER(1, TIMER_TYPE_PERIODIC, 10, 6, read_sensor));
+
+    flexitimer_static_handler(&sensors);
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_STATIC_H
+#define FLEXITIMER_STATIC_H
+
+#include "flexitimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+    @brief Static timer entry, read-only.
+*/
+typedef struct
+{
+    timer_callback_t callback;
+    timer_time_t period;    // ticks between expiries, a single-shot timer expires once after the phase
+    timer_time_t phase;     // ticks until the first expiry, 0 for one period
+    timer_id_t id;          // passed to the callback and to the functions below
+    uint8_t type;           // timer_type_t
+} flexitimer_static_timer_t;
+
+/**
+    @brief Mutable state of a static timer, all zero at startup.
+*/
+typedef struct
+{
+    timer_time_t elapsed;   // ticks since the startup, the last restart or the last expiry
+    uint8_t flags;
+} flexitimer_static_counter_t;
+
+/**
+    @brief Static timer table.
+*/
+typedef struct
+{
+    const flexitimer_static_timer_t *timers;
+    flexitimer_static_counter_t *counters;
+    uint32_t count;
+} flexitimer_static_t;
+
+/**
+    @brief Static timer entry initializer.
+    @param id Timer identifier.
+    @param type Timer type.
+    @param period Period in ticks, expiries of 0 ticks take 1 tick.
+    @param phase Ticks until the first expiry, 0 for one period.
+    @param callback Callback function, NULL for none.
+*/
+#define FLEXITIMER_STATIC_TIMER(id, type, period, phase, callback) \
+    { (callback), (timer_time_t)(period), (timer_time_t)(phase), (timer_id_t)(id), (uint8_t)(type) }
+
+/**
+    @brief Defines a static timer table of the given entries and its counters.
+    @param name Name of the flexitimer_static_t table, functions take its address.
+*/
+#define FLEXITIMER_STATIC_TABLE(name, ...)                                                              \
+    static const flexitimer_static_timer_t name##_timers[] = { __VA_ARGS__ };                           \
+    static flexitimer_static_counter_t name##_counters[sizeof(name##_timers) / sizeof(name##_timers[0])]; \
+    static const flexitimer_static_t name = { name##_timers, name##_counters, (uint32_t)(sizeof(name##_timers) / sizeof(name##_timers[0])) }
+
+/**
+    @brief Processes one tick of a table, to be called alongside flexitimer_handler().
+    @param table Static timer table.
+*/
+void flexitimer_static_handler(const flexitimer_static_t *table);
+
+/**
+    @brief Processes several elapsed ticks of a table at once, see flexitimer_advance().
+    @param table Static timer table.
+    @param ticks Number of elapsed ticks.
+*/
+void flexitimer_static_advance(const flexitimer_static_t *table, timer_time_t ticks);
+
+/**
+    @brief Gets the ticks until the earliest expiry of a table.
+    @param table Static timer table.
+    @param ticks Pointer to store the ticks.
+    @return Error code, FLEXITIMER_ERROR_INVALID_STATE if no timer is active.
+*/
+flexitimer_error_t flexitimer_static_next_expiry(const flexitimer_static_t *table, timer_time_t *ticks);
+
+/**
+    @brief Static timer operations by id, see flexitimer_pause(), flexitimer_resume(),
+    flexitimer_restart(), flexitimer_cancel(), flexitimer_get_state() and flexitimer_get_elapsed().
+    A restart runs the timer from a full period, also after a cancel.
+*/
+flexitimer_error_t flexitimer_static_pause(const flexitimer_static_t *table, timer_id_t id);
+flexitimer_error_t flexitimer_static_resume(const flexitimer_static_t *table, timer_id_t id);
+flexitimer_error_t flexitimer_static_restart(const flexitimer_static_t *table, timer_id_t id);
+flexitimer_error_t flexitimer_static_cancel(const flexitimer_static_t *table, timer_id_t id);
+flexitimer_error_t flexitimer_static_get_state(const flexitimer_static_t *table, timer_id_t id, timer_state_t *state);
+flexitimer_error_t flexitimer_static_get_elapsed(const flexitimer_static_t *table, timer_id_t id, timer_time_t *time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLEXITIMER_STATIC_H
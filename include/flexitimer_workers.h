@@ -0,0 +1,91 @@
+/**
+    @file flexitimer_workers.h
+    @brief FlexiTimer Scheduler Library - callback worker pool
+
+    A bounded pool of POSIX threads that runs the callbacks of the DEFERRED timers of a context,
+    so a blocking callback no longer holds up the handler and the timers expiring after it.
+    The handler only collects the expired ids, the batch is handed over once per handler call.
+    A callback never runs concurrently with itself: expirations of a timer whose callback is
+    queued or running are counted and run one after the other by the same worker.
+
+    Deferred callbacks run on the worker threads, they must use the flexitimer_post functions
+    to operate on the context.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_WORKERS_H
+#define FLEXITIMER_WORKERS_H
+
+#include "flexitimer.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+    @brief Maximum number of worker threads of a pool.
+*/
+#ifndef FLEXITIMER_WORKERS_MAX
+#define FLEXITIMER_WORKERS_MAX (16)
+#endif
+
+/**
+    @brief Per-timer state of a worker pool, one per timer of the context.
+    Its members are private to the library.
+*/
+typedef struct
+{
+    timer_callback_t callback;      // callback of the latest expiration handed over
+    uint32_t owed;                  // expirations handed over and not run yet
+    flexitimer_node_t next;         // run queue link
+    uint8_t queued;                 // in the run queue or running
+    timer_callback_t batched;       // handler side: callback of the latest expiration
+    uint32_t fires;                 // handler side: expirations in the current batch
+    flexitimer_node_t batch_next;   // handler side: batch link
+} flexitimer_worker_slot_t;
+
+/**
+    @brief Worker pool structure. Its members are private to the library.
+*/
+typedef struct
+{
+    flexitimer_ctx_t *ctx;
+    flexitimer_worker_slot_t *slots;
+    uint32_t count;
+    pthread_t threads[FLEXITIMER_WORKERS_MAX];
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    flexitimer_node_t head;         // run queue, under the lock
+    flexitimer_node_t tail;
+    flexitimer_node_t batch;        // handler side: ids expired since the last flush
+    uint8_t running;
+} flexitimer_workers_t;
+
+/**
+    @brief Starts a worker pool and makes it the dispatcher of a context.
+    @param workers Worker pool.
+    @param ctx Scheduler context, NULL for the default context.
+    @param slots Per-timer state, one entry per timer of the context, must stay valid while the pool runs.
+    @param count Number of worker threads, 1 to FLEXITIMER_WORKERS_MAX.
+    @return Error code, FLEXITIMER_ERROR_SYSTEM with errno set if a thread cannot be created.
+*/
+flexitimer_error_t flexitimer_workers_init(flexitimer_workers_t *workers, flexitimer_ctx_t *ctx, flexitimer_worker_slot_t *slots, uint32_t count);
+
+/**
+    @brief Detaches the pool from its context, runs the callbacks already handed over and
+    stops the worker threads. To be called from the thread running the handler.
+    @param workers Worker pool.
+*/
+void flexitimer_workers_deinit(flexitimer_workers_t *workers);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLEXITIMER_WORKERS_H
@@ -15,232 +15,1563 @@
     @license MIT License
 */
 
-#include "flexitimer.h"
+#include "flexitimer_internal.h"
 #include <stdio.h> // for NULL
 
-/**
-    @brief Timer structure.
-*/
-typedef struct
+#define NODE_NONE       ((flexitimer_node_t)UINT32_MAX)
+#define PENDING_QUEUED  (0x01u) // linked into the dispatch queue of a class
+#define PENDING_LIVE    (0x02u) // the callback is still to run, a cancel or start drops it
+
+static flexitimer_timer_t default_timers[FLEXITIMER_MAX_TIMERS];
+static flexitimer_ctx_t default_ctx;
+
+/* Stores the callback of a timer, as its callback table index if the records use one */
+static flexitimer_error_t flexitimer_bind(const flexitimer_ctx_t *ctx, flexitimer_timer_t *timer, timer_callback_t callback)
 {
-    timer_time_t timeout;
-    timer_time_t remaining;
-    timer_type_t type;
-    timer_state_t state;
-    timer_callback_t callback;
-} timer_t;
+#if FLEXITIMER_CALLBACK_TABLE
+    uint32_t index = 0;
 
-static timer_t timers[FLEXITIMER_MAX_TIMERS];
+    if(callback != NULL)
+    {
+        while((index < ctx->callback_count) && (ctx->callbacks[index] != callback))
+        {
+            index++;
+        }
 
-/* Initializes the scheduler */
-void flexitimer_init(void)
+        if(index == ctx->callback_count)
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+
+        index++;
+    }
+
+    timer->callback = (uint8_t)index;
+#else
+    (void)ctx;
+    timer->callback = callback;
+#endif
+    return FLEXITIMER_OK;
+}
+
+/* Gets the callback of a timer */
+static timer_callback_t flexitimer_callback(const flexitimer_ctx_t *ctx, const flexitimer_timer_t *timer)
+{
+#if FLEXITIMER_CALLBACK_TABLE
+    return (timer->callback != 0u) ? ctx->callbacks[timer->callback - 1u] : NULL;
+#else
+    (void)ctx;
+    return timer->callback;
+#endif
+}
+
+/* Initializes a scheduler context */
+flexitimer_error_t flexitimer_ctx_init(flexitimer_ctx_t *ctx, flexitimer_timer_t *storage, uint32_t capacity)
+{
+    if((ctx == NULL) || (storage == NULL) || (capacity == 0u))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if((uint32_t)(timer_id_t)(capacity - 1u) != (capacity - 1u))
+    {
+        return FLEXITIMER_ERROR_INVALID_ID; // ids would not fit timer_id_t
+    }
+
+#if (FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_SCAN) && FLEXITIMER_SCAN_SOA
+    if(capacity > FLEXITIMER_MAX_TIMERS)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID; // the lanes are sized for FLEXITIMER_MAX_TIMERS
+    }
+#endif
+
+#if FLEXITIMER_HANDLES && (FLEXITIMER_HANDLE_INDEX_BITS < 32u)
+    if(capacity > (1u << FLEXITIMER_HANDLE_INDEX_BITS))
+    {
+        return FLEXITIMER_ERROR_INVALID_ID; // indexes would not fit flexitimer_handle_t
+    }
+#endif
+
+    ctx->timers = storage;
+    ctx->capacity = capacity;
+#if FLEXITIMER_CALLBACK_TABLE
+    ctx->callbacks = NULL;
+    ctx->callback_count = 0;
+#endif
+
+    for(uint32_t i = 0; i < capacity; i++)
+    {
+        storage[i].timeout = 0;
+        storage[i].remaining = 0;
+        storage[i].type = TIMER_TYPE_SINGLESHOT;
+        storage[i].state = TIMER_STATE_PASSIVE;
+        (void)flexitimer_bind(ctx, &storage[i], NULL);
+#if FLEXITIMER_SLACK
+        storage[i].slack = 0;
+        storage[i].slip = 0;
+#endif
+        storage[i].catchup = (uint8_t)FLEXITIMER_CATCHUP_ALL;
+        storage[i].dispatch = (uint8_t)FLEXITIMER_DISPATCH_INLINE;
+#if FLEXITIMER_PRIORITIES
+        storage[i].priority = (uint8_t)FLEXITIMER_PRIORITY_NORMAL;
+        storage[i].pending = 0;
+        storage[i].pending_next = NODE_NONE;
+        storage[i].pending_since = 0;
+#endif
+#if FLEXITIMER_GROUPS
+        storage[i].group = 0;
+        storage[i].group_epoch = 0;
+        storage[i].group_lag = 0;
+#endif
+    }
+
+    flexitimer_engine_init(ctx);
+    ctx->target = 0;
+    ctx->time_source = NULL;
+    ctx->source_time = 0;
+    flexitimer_ctx_set_dispatcher(ctx, NULL);
+#if FLEXITIMER_HANDLES
+    flexitimer_pool_init(ctx);
+#endif
+#if FLEXITIMER_STATS
+    flexitimer_ctx_set_clock(ctx, NULL, UINT64_MAX);
+    flexitimer_ctx_reset_stats(ctx);
+#endif
+#if FLEXITIMER_TRACE
+    (void)flexitimer_ctx_set_trace(ctx, NULL, 0u, NULL);
+#endif
+#if FLEXITIMER_GROUPS
+    ctx->groups = NULL;
+    ctx->group_count = 0;
+#endif
+#if FLEXITIMER_PRIORITIES
+    for(uint32_t i = 0; i < FLEXITIMER_PRIORITY_CLASSES; i++)
+    {
+        ctx->classes[i].head = NODE_NONE;
+        ctx->classes[i].tail = NODE_NONE;
+    }
+
+    flexitimer_ctx_reset_class_stats(ctx);
+    (void)flexitimer_ctx_set_budget(ctx, 0u, 0u, NULL);
+#endif
+#if FLEXITIMER_SNAPSHOT
+    ctx->write_depth = 0;
+    ctx->sequence = 0;
+#endif
+#if FLEXITIMER_QUEUE_SIZE > 0
+    flexitimer_queue_init(ctx);
+#endif
+    return FLEXITIMER_OK;
+}
+
+/* Drops the callback of a timer that waits for dispatch, the timer leaves the queue lazily */
+static void flexitimer_drop_pending(flexitimer_timer_t *timer)
+{
+#if FLEXITIMER_PRIORITIES
+    timer->pending &= (uint8_t)~PENDING_LIVE;
+#else
+    (void)timer;
+#endif
+}
+
+/* Arms a timer to expire after the given ticks of its group clock */
+static void flexitimer_arm_ticks(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    flexitimer_engine_arm(ctx, id, ticks);
+#if FLEXITIMER_GROUPS
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(timer->group != 0u)
+    {
+        timer->group_lag = flexitimer_group_lag(ctx, &ctx->groups[timer->group - 1u]);
+    }
+#endif
+}
+
+/* Cancels a timer whose group was cancelled after its start, the cancel reaches members lazily */
+void flexitimer_group_sync(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+#if FLEXITIMER_GROUPS
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(flexitimer_group_cancelled(ctx, id) != 0)
+    {
+        flexitimer_write_begin(ctx);
+
+        if(timer->state == TIMER_STATE_ACTIVE)
+        {
+            flexitimer_engine_disarm(ctx, id);
+        }
+
+        timer->state = TIMER_STATE_PASSIVE;
+        timer->remaining = 0;
+        timer->group_epoch = ctx->groups[timer->group - 1u].epoch;
+        (void)flexitimer_bind(ctx, timer, NULL);
+        flexitimer_drop_pending(timer);
+        flexitimer_write_end(ctx);
+    }
+#else
+    (void)ctx;
+    (void)id;
+#endif
+}
+
+/* Gets the ticks the armed expiry of a timer lies past its nominal deadline */
+static timer_time_t flexitimer_slip(const flexitimer_timer_t *timer)
+{
+#if FLEXITIMER_SLACK
+    return timer->slip;
+#else
+    (void)timer;
+    return 0u;
+#endif
+}
+
+#if FLEXITIMER_SLACK
+/* Arms a timer, deferring its expiry within the slack window to a coarsely aligned tick */
+static void flexitimer_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    flexitimer_timer_t *timer = &ctx->timers[id];
+    timer_time_t deadline = ctx->now + ((ticks == 0u) ? 1u : ticks);
+    timer_time_t limit = deadline + timer->slack;
+    timer->slip = 0;
+
+    if(limit > deadline)
+    {
+        /* Keep the bits above the highest one that differs, the rest of the window is cleared */
+        timer_time_t mask = deadline ^ limit;
+        mask |= mask >> 1u;
+        mask |= mask >> 2u;
+        mask |= mask >> 4u;
+        mask |= mask >> 8u;
+        mask |= mask >> 16u;
+        timer->slip = (limit & ~(mask >> 1u)) - deadline;
+    }
+
+    flexitimer_arm_ticks(ctx, id, (timer->slip == 0u) ? ticks : (deadline - ctx->now + timer->slip));
+}
+#else
+/* Arms a timer on its deadline */
+static void flexitimer_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    flexitimer_arm_ticks(ctx, id, ticks);
+}
+#endif
+
+/* Checks the timing parameters of a start */
+static flexitimer_error_t flexitimer_check_start(timer_type_t type, timer_time_t timeout, timer_time_t slack)
+{
+    if(type == TIMER_TYPE_PERIODIC && timeout == 0)
+    {
+        return FLEXITIMER_ERROR_ZERO_TIMEOUT;
+    }
+
+    if(type == TIMER_TYPE_PERIODIC && slack >= timeout)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG; // the next deadline would come before the expiry
+    }
+
+#if FLEXITIMER_COUNTER_BITS < 32
+    if(timeout > FLEXITIMER_COUNTER_MAX)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+#endif
+
+    if(slack > (FLEXITIMER_COUNTER_MAX - ((timeout == 0u) ? 1u : timeout)))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG; // the deferred expiry would not fit the counters
+    }
+
+    return FLEXITIMER_OK;
+}
+
+/* Starts a validated timer whose callback is bound, within an update */
+static void flexitimer_apply_start(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_time_t slack)
+{
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(timer->state == TIMER_STATE_ACTIVE)
+    {
+        flexitimer_engine_disarm(ctx, id);
+    }
+
+    timer->timeout = timeout;
+    timer->remaining = timeout;
+    timer->type = type;
+    timer->state = TIMER_STATE_ACTIVE;
+#if FLEXITIMER_SLACK
+    timer->slack = slack;
+#else
+    (void)slack;
+#endif
+#if FLEXITIMER_GROUPS
+    timer->group = 0;
+#endif
+    flexitimer_drop_pending(timer);
+    flexitimer_arm(ctx, id, timeout);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_START, id, timeout);
+}
+
+/* Cancels a valid timer, within an update */
+static void flexitimer_apply_cancel(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(timer->state == TIMER_STATE_ACTIVE)
+    {
+        flexitimer_engine_disarm(ctx, id);
+    }
+
+    timer->state = TIMER_STATE_PASSIVE;
+    timer->remaining = 0;
+    (void)flexitimer_bind(ctx, timer, NULL);
+    flexitimer_drop_pending(timer);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_CANCEL, id, 0u);
+}
+
+/* Gets the id of the index-th timer of a bulk operation */
+static timer_id_t flexitimer_bulk_id(const timer_id_t *ids, uint32_t index)
+{
+    return (ids != NULL) ? ids[index] : (timer_id_t)index;
+}
+
+/* Checks the ids of a bulk operation */
+static flexitimer_error_t flexitimer_check_ids(const flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(ids == NULL)
+    {
+        return (count <= ctx->capacity) ? FLEXITIMER_OK : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(ids[i] >= ctx->capacity)
+        {
+            return FLEXITIMER_ERROR_INVALID_ID;
+        }
+    }
+
+    return FLEXITIMER_OK;
+}
+
+/* Starts a timer with the specified parameters */
+flexitimer_error_t flexitimer_ctx_start(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    return flexitimer_ctx_start_ex(ctx, id, type, timeout, 0u, callback);
+}
+
+/* Starts a timer with a slack window */
+flexitimer_error_t flexitimer_ctx_start_ex(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_time_t slack, timer_callback_t callback)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    flexitimer_error_t error = flexitimer_check_start(type, timeout, slack);
+
+    if(error != FLEXITIMER_OK)
+    {
+        return error;
+    }
+
+    if(flexitimer_bind(ctx, &ctx->timers[id], callback) != FLEXITIMER_OK)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    flexitimer_write_begin(ctx);
+    flexitimer_apply_start(ctx, id, type, timeout, slack);
+    flexitimer_write_end(ctx);
+    return FLEXITIMER_OK;
+}
+
+/* Runs the callback of an expired timer, or hands it over to the dispatcher */
+static void flexitimer_dispatch(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    const flexitimer_timer_t *timer = &ctx->timers[id];
+
+#if FLEXITIMER_STATS
+    flexitimer_clock_t clock = ctx->clock;
+    uint64_t start = (clock != NULL) ? clock() : 0u;
+#endif
+
+    timer_callback_t callback = flexitimer_callback(ctx, timer);
+
+    if(callback)
+    {
+        /* The timers are consistent here, snapshot readers need not wait for the callback */
+        flexitimer_write_end(ctx);
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_FIRE_BEGIN, id, 0u);
+
+        if((timer->dispatch == (uint8_t)FLEXITIMER_DISPATCH_DEFERRED) && (ctx->dispatcher.submit != NULL))
+        {
+            ctx->dispatcher.submit(ctx->dispatcher.arg, id, callback);
+        }
+        else
+        {
+            callback(id);
+        }
+
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_FIRE_END, id, 0u);
+        flexitimer_write_begin(ctx);
+    }
+
+#if FLEXITIMER_STATS
+    flexitimer_stats_record(ctx, id, (clock != NULL) ? (clock() - start) : 0u);
+#endif
+}
+
+#if FLEXITIMER_PRIORITIES
+/* Unlinks a queued timer from the dispatch queue of its class, a walk of that queue */
+static void flexitimer_unqueue(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    flexitimer_timer_t *timer = &ctx->timers[id];
+    flexitimer_class_t *queue = &ctx->classes[timer->priority];
+    flexitimer_node_t previous = NODE_NONE;
+    flexitimer_node_t node = queue->head;
+
+    while(node != (flexitimer_node_t)id)
+    {
+        previous = node;
+        node = ctx->timers[node].pending_next;
+    }
+
+    if(previous == NODE_NONE)
+    {
+        queue->head = timer->pending_next;
+    }
+    else
+    {
+        ctx->timers[previous].pending_next = timer->pending_next;
+    }
+
+    if(queue->tail == (flexitimer_node_t)id)
+    {
+        queue->tail = previous;
+    }
+
+    timer->pending &= (uint8_t)~PENDING_QUEUED;
+}
+
+/* Queues the callback of an expired timer in its priority class */
+static void flexitimer_enqueue(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    flexitimer_timer_t *timer = &ctx->timers[id];
+    flexitimer_class_t *queue = &ctx->classes[timer->priority];
+
+    if((timer->pending & PENDING_LIVE) != 0u)
+    {
+        queue->stats.coalesced++; // the waiting callback stands for this expiry as well
+        return;
+    }
+
+    timer->pending_since = ctx->now;
+
+    /* A dropped callback still linked keeps no place, the new expiry queues behind the others */
+    if((timer->pending & PENDING_QUEUED) != 0u)
+    {
+        flexitimer_unqueue(ctx, id);
+    }
+
+    timer->pending_next = NODE_NONE;
+
+    if(queue->tail != NODE_NONE)
+    {
+        ctx->timers[queue->tail].pending_next = (flexitimer_node_t)id;
+    }
+    else
+    {
+        queue->head = (flexitimer_node_t)id;
+    }
+
+    queue->tail = (flexitimer_node_t)id;
+    timer->pending = PENDING_QUEUED | PENDING_LIVE;
+}
+#endif
+
+/* Expires the specified timer, called by the engine */
+void flexitimer_expire(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+#if FLEXITIMER_GROUPS
+    if(timer->group != 0u)
+    {
+        flexitimer_group_t *group = &ctx->groups[timer->group - 1u];
+
+        if(timer->group_epoch != group->epoch)
+        {
+            /* Cancelled with its group, the engine drops it as it is left passive */
+            timer->state = TIMER_STATE_PASSIVE;
+            timer->remaining = 0;
+            timer->group_epoch = group->epoch;
+            (void)flexitimer_bind(ctx, timer, NULL);
+            flexitimer_drop_pending(timer);
+            return;
+        }
+
+        timer_time_t lag = flexitimer_group_lag(ctx, group) - timer->group_lag;
+
+        if(lag > 0u)
+        {
+            /* The group was delayed or paused since the timer was armed, it expires that much later */
+            timer_time_t step = (lag < FLEXITIMER_COUNTER_MAX) ? lag : FLEXITIMER_COUNTER_MAX;
+            timer->group_lag += step;
+            flexitimer_engine_arm(ctx, id, step);
+            return;
+        }
+    }
+#endif
+
+    if(timer->type == TIMER_TYPE_PERIODIC)
+    {
+        /* Re-armed from the nominal deadline, ticks between it and the target were missed */
+        timer_time_t late = (ctx->target - ctx->now) + flexitimer_slip(timer);
+        timer_time_t periods = 1u;
+        uint8_t catchup = (ctx->target != ctx->now) ? timer->catchup : (uint8_t)FLEXITIMER_CATCHUP_ALL;
+
+        if(catchup == (uint8_t)FLEXITIMER_CATCHUP_COALESCE)
+        {
+            /* This firing stands for all periods up to the target */
+            periods = (late / timer->timeout) + 1u;
+        }
+        else if(catchup == (uint8_t)FLEXITIMER_CATCHUP_SKIP)
+        {
+            /* The missed firings are dropped, the next one is on time */
+            periods = (late + timer->timeout - 1u) / timer->timeout;
+        }
+
+#if FLEXITIMER_COUNTER_BITS < 32
+        /* Narrow counters hold fewer periods, a longer catch-up then takes several expiries */
+#if FLEXITIMER_SLACK
+        timer_time_t most = (FLEXITIMER_COUNTER_MAX - timer->slack + timer->slip) / timer->timeout;
+#else
+        timer_time_t most = FLEXITIMER_COUNTER_MAX / timer->timeout;
+#endif
+        periods = (periods < most) ? periods : most;
+#endif
+
+        flexitimer_arm(ctx, id, (periods * timer->timeout) - flexitimer_slip(timer));
+
+        if(catchup == (uint8_t)FLEXITIMER_CATCHUP_SKIP)
+        {
+            return;
+        }
+    }
+    else
+    {
+        timer->state = TIMER_STATE_PASSIVE;
+        timer->remaining = 0;
+    }
+
+#if FLEXITIMER_PRIORITIES
+    flexitimer_enqueue(ctx, id);
+#else
+    flexitimer_dispatch(ctx, id);
+#endif
+}
+
+#if FLEXITIMER_PRIORITIES
+/* Checks whether the dispatch budget of the running handler call is spent */
+static uint32_t flexitimer_budget_spent(const flexitimer_ctx_t *ctx)
+{
+    if((ctx->budget_callbacks != 0u) && (ctx->budget_used >= ctx->budget_callbacks))
+    {
+        return 1u;
+    }
+
+    if((ctx->budget_time != 0u) && (ctx->budget_clock != NULL) && ((ctx->budget_clock() - ctx->budget_start) >= ctx->budget_time))
+    {
+        return 1u;
+    }
+
+    return 0u;
+}
+
+/* Starts the dispatch budget of a handler call */
+static void flexitimer_budget_begin(flexitimer_ctx_t *ctx)
+{
+    ctx->budget_used = 0;
+    ctx->budget_start = ((ctx->budget_time != 0u) && (ctx->budget_clock != NULL)) ? ctx->budget_clock() : 0u;
+}
+
+/* Runs the queued callbacks class by class, the classes below HIGH as long as the budget lasts */
+static void flexitimer_dispatch_pending(flexitimer_ctx_t *ctx)
 {
-    for(timer_id_t i = 0; i < FLEXITIMER_MAX_TIMERS; i++)
+    for(uint32_t priority = 0; priority < FLEXITIMER_PRIORITY_CLASSES; priority++)
     {
-        flexitimer_cancel(i);
+        flexitimer_class_t *queue = &ctx->classes[priority];
+
+        while(queue->head != NODE_NONE)
+        {
+            if((priority != (uint32_t)FLEXITIMER_PRIORITY_HIGH) && (flexitimer_budget_spent(ctx) != 0u))
+            {
+                return; // carried into the next handler call
+            }
+
+            timer_id_t id = (timer_id_t)queue->head;
+            flexitimer_timer_t *timer = &ctx->timers[id];
+            uint8_t live = timer->pending & PENDING_LIVE;
+            queue->head = timer->pending_next;
+            timer->pending = 0;
+
+            if(queue->head == NODE_NONE)
+            {
+                queue->tail = NODE_NONE;
+            }
+
+#if FLEXITIMER_GROUPS
+            if((timer->group != 0u) && (timer->group_epoch != ctx->groups[timer->group - 1u].epoch))
+            {
+                live = 0u; // cancelled with its group
+            }
+#endif
+
+            if(live != 0u)
+            {
+                timer_time_t wait = ctx->now - timer->pending_since;
+                queue->stats.dispatched++;
+                queue->stats.carried += (wait > 0u) ? 1u : 0u;
+                queue->stats.max_wait = (wait > queue->stats.max_wait) ? wait : queue->stats.max_wait;
+                ctx->budget_used++;
+                flexitimer_dispatch(ctx, id);
+            }
+        }
+    }
+}
+#endif
+
+/* Handler function to be called in a loop */
+void flexitimer_ctx_handler(flexitimer_ctx_t *ctx)
+{
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_TICK_BEGIN, 0u, 1u);
+    flexitimer_write_begin(ctx);
+#if FLEXITIMER_QUEUE_SIZE > 0
+    (void)flexitimer_queue_drain(ctx);
+#endif
+    ctx->target = ctx->now + 1u;
+#if FLEXITIMER_PRIORITIES
+    flexitimer_budget_begin(ctx);
+    flexitimer_engine_tick(ctx);
+    flexitimer_dispatch_pending(ctx);
+#else
+    flexitimer_engine_tick(ctx);
+#endif
+    flexitimer_write_end(ctx);
+
+    if(ctx->dispatcher.flush != NULL)
+    {
+        ctx->dispatcher.flush(ctx->dispatcher.arg);
+    }
+
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_TICK_END, 0u, 0u);
+}
+
+/* Processes several elapsed ticks at once */
+void flexitimer_ctx_advance(flexitimer_ctx_t *ctx, timer_time_t ticks)
+{
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_TICK_BEGIN, 0u, ticks);
+    flexitimer_write_begin(ctx);
+#if FLEXITIMER_QUEUE_SIZE > 0
+    (void)flexitimer_queue_drain(ctx);
+#endif
+    ctx->target = ctx->now + ticks;
+#if FLEXITIMER_PRIORITIES
+    flexitimer_budget_begin(ctx);
+#endif
+
+    while(ticks > 0u)
+    {
+        /* Callbacks may arm earlier timers, so the next expiry is looked up after every tick */
+        timer_time_t next = flexitimer_engine_next(ctx);
+
+        if((next == 0u) || (next > ticks))
+        {
+            flexitimer_engine_skip(ctx, ticks);
+            break;
+        }
+
+        flexitimer_engine_skip(ctx, next - 1u);
+        flexitimer_engine_tick(ctx);
+#if FLEXITIMER_PRIORITIES
+        flexitimer_dispatch_pending(ctx);
+#endif
+        ticks -= next;
+    }
+
+#if FLEXITIMER_PRIORITIES
+    flexitimer_dispatch_pending(ctx); // callbacks carried from an earlier call without an expiry in this one
+#endif
+    flexitimer_write_end(ctx);
+
+    if(ctx->dispatcher.flush != NULL)
+    {
+        ctx->dispatcher.flush(ctx->dispatcher.arg);
+    }
+
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_TICK_END, 0u, 0u);
+}
+
+/* Processes the ticks elapsed on the time source */
+void flexitimer_ctx_poll(flexitimer_ctx_t *ctx)
+{
+    if((ctx != NULL) && (ctx->time_source != NULL))
+    {
+        timer_time_t time = ctx->time_source();
+        timer_time_t elapsed = time - ctx->source_time;
+        ctx->source_time = time;
+        flexitimer_ctx_advance(ctx, elapsed);
+    }
+}
+
+/* Sets the time source of a context */
+void flexitimer_ctx_set_time_source(flexitimer_ctx_t *ctx, flexitimer_time_source_t source)
+{
+    if(ctx != NULL)
+    {
+        ctx->time_source = source;
+        ctx->source_time = (source != NULL) ? source() : 0u;
+    }
+}
+
+/* Gets the ticks until the earliest expiry */
+flexitimer_error_t flexitimer_ctx_next_expiry(flexitimer_ctx_t *ctx, timer_time_t *ticks)
+{
+    if((ctx == NULL) || (ticks == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    flexitimer_write_begin(ctx);
+#if FLEXITIMER_QUEUE_SIZE > 0
+    (void)flexitimer_queue_drain(ctx);
+#endif
+    *ticks = flexitimer_engine_next(ctx);
+#if FLEXITIMER_PRIORITIES
+    for(uint32_t i = 0; i < FLEXITIMER_PRIORITY_CLASSES; i++)
+    {
+        if(ctx->classes[i].head != NODE_NONE)
+        {
+            *ticks = 1u; // callbacks carried over wait for the next handler call
+        }
+    }
+#endif
+    flexitimer_write_end(ctx);
+    return (*ticks > 0u) ? FLEXITIMER_OK : FLEXITIMER_ERROR_INVALID_STATE;
+}
+
+/* Gets the ticks processed since the initialization */
+flexitimer_error_t flexitimer_ctx_get_now(const flexitimer_ctx_t *ctx, timer_time_t *now)
+{
+    if((ctx == NULL) || (now == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    *now = ctx->now;
+    return FLEXITIMER_OK;
+}
+
+/* Delays the specified timer */
+flexitimer_error_t flexitimer_ctx_delay(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t delay)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    flexitimer_group_sync(ctx, id);
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(timer->state == TIMER_STATE_ACTIVE)
+    {
+        timer_time_t remaining = flexitimer_timer_remaining(ctx, id);
+
+        if(delay > (FLEXITIMER_COUNTER_MAX - remaining))
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+
+        flexitimer_write_begin(ctx);
+        flexitimer_engine_disarm(ctx, id);
+        flexitimer_arm_ticks(ctx, id, remaining + delay);
+        flexitimer_write_end(ctx);
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_DELAY, id, delay);
+        return FLEXITIMER_OK;
+    }
+
+    if(timer->state == TIMER_STATE_PAUSED)
+    {
+        if(delay > (timer_time_t)(FLEXITIMER_COUNTER_MAX - timer->remaining))
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+
+        flexitimer_write_begin(ctx);
+        timer->remaining += delay;
+        flexitimer_write_end(ctx);
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_DELAY, id, delay);
+        return FLEXITIMER_OK;
+    }
+
+    return FLEXITIMER_ERROR_INVALID_STATE;
+}
+
+/* Pauses the specified timer */
+flexitimer_error_t flexitimer_ctx_pause(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    flexitimer_group_sync(ctx, id);
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(flexitimer_timer_state(ctx, id) == TIMER_STATE_ACTIVE)
+    {
+        flexitimer_write_begin(ctx);
+        timer->remaining = flexitimer_timer_remaining(ctx, id);
+        flexitimer_engine_disarm(ctx, id);
+        timer->state = TIMER_STATE_PAUSED;
+        flexitimer_write_end(ctx);
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_PAUSE, id, 0u);
+        return FLEXITIMER_OK;
     }
+
+    return FLEXITIMER_ERROR_INVALID_STATE;
+}
+
+/* Resumes the specified timer */
+flexitimer_error_t flexitimer_ctx_resume(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    flexitimer_group_sync(ctx, id);
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(timer->state == TIMER_STATE_PAUSED)
+    {
+        flexitimer_write_begin(ctx);
+        timer->state = TIMER_STATE_ACTIVE;
+        flexitimer_arm_ticks(ctx, id, timer->remaining);
+        flexitimer_write_end(ctx);
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_RESUME, id, 0u);
+        return FLEXITIMER_OK;
+    }
+
+    return FLEXITIMER_ERROR_INVALID_STATE;
+}
+
+/* Restarts the specified timer */
+flexitimer_error_t flexitimer_ctx_restart(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    flexitimer_group_sync(ctx, id);
+    flexitimer_timer_t *timer = &ctx->timers[id];
+
+    if(flexitimer_callback(ctx, timer) != NULL)
+    {
+        flexitimer_write_begin(ctx);
+
+        if(timer->state == TIMER_STATE_ACTIVE)
+        {
+            flexitimer_engine_disarm(ctx, id);
+        }
+
+        timer->remaining = timer->timeout;
+        timer->state = TIMER_STATE_ACTIVE;
+        flexitimer_drop_pending(timer);
+        flexitimer_arm(ctx, id, timer->timeout);
+        flexitimer_write_end(ctx);
+        flexitimer_trace(ctx, FLEXITIMER_TRACE_RESTART, id, 0u);
+        return FLEXITIMER_OK;
+    }
+
+    return FLEXITIMER_ERROR_INVALID_STATE;
+}
+
+/* Cancels the specified timer */
+flexitimer_error_t flexitimer_ctx_cancel(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    flexitimer_write_begin(ctx);
+    flexitimer_apply_cancel(ctx, id);
+    flexitimer_write_end(ctx);
+    return FLEXITIMER_OK;
+}
+
+/* Gets the state of the specified timer */
+flexitimer_error_t flexitimer_ctx_get_state(flexitimer_ctx_t *ctx, timer_id_t id, timer_state_t *state)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if(state == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    *state = flexitimer_timer_state(ctx, id);
+    return FLEXITIMER_OK;
+}
+
+/* Gets the type of the specified timer */
+flexitimer_error_t flexitimer_ctx_get_type(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t *type)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if(type == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    *type = ctx->timers[id].type;
+    return FLEXITIMER_OK;
+}
+
+/* Gets the original timeout of the specified timer */
+flexitimer_error_t flexitimer_ctx_get_time(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t *time)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if(time == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    *time = ctx->timers[id].timeout;
+    return FLEXITIMER_OK;
+}
+
+/* Gets the remaining time of the specified timer */
+flexitimer_error_t flexitimer_ctx_get_elapsed(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t *time)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if(time == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    *time = flexitimer_timer_remaining(ctx, id);
+    return FLEXITIMER_OK;
 }
 
-/* Starts a timer with the specified parameters */
-flexitimer_error_t flexitimer_start(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+/* Starts several timers with the same parameters */
+flexitimer_error_t flexitimer_ctx_start_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    flexitimer_error_t error = flexitimer_check_ids(ctx, ids, count);
+
+    if(error == FLEXITIMER_OK)
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        error = flexitimer_check_start(type, timeout, 0u);
     }
 
-    if(type == TIMER_TYPE_PERIODIC && timeout == 0)
+    if((error != FLEXITIMER_OK) || (count == 0u))
     {
-        return FLEXITIMER_ERROR_ZERO_TIMEOUT;
+        return error;
     }
 
-    timers[id].timeout = timeout;
-    timers[id].remaining = timeout;
-    timers[id].type = type;
-    timers[id].state = TIMER_STATE_ACTIVE;
-    timers[id].callback = callback;
-    return FLEXITIMER_OK;
-}
+    /* The callback is looked up once, the other timers copy the binding of the first one */
+    flexitimer_timer_t *first = &ctx->timers[flexitimer_bulk_id(ids, 0u)];
 
-/* Handler function to be called in a loop */
-void flexitimer_handler(void)
-{
-    for(timer_id_t i = 0; i < FLEXITIMER_MAX_TIMERS; i++)
+    if(flexitimer_bind(ctx, first, callback) != FLEXITIMER_OK)
     {
-        if(timers[i].state == TIMER_STATE_ACTIVE)
-        {
-            if(timers[i].remaining > 0)
-            {
-                timers[i].remaining--;
-            }
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
 
-            if(timers[i].remaining == 0)
-            {
-                if(timers[i].type == TIMER_TYPE_PERIODIC)
-                {
-                    timers[i].remaining = timers[i].timeout;
-                }
-                else
-                {
-                    timers[i].state = TIMER_STATE_PASSIVE;
-                }
-
-                if(timers[i].callback)
-                {
-                    timers[i].callback(i);
-                }
-            }
-        }
+    flexitimer_write_begin(ctx);
+    flexitimer_engine_batch_begin(ctx, count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        timer_id_t id = flexitimer_bulk_id(ids, i);
+        ctx->timers[id].callback = first->callback;
+        flexitimer_apply_start(ctx, id, type, timeout, 0u);
     }
+
+    flexitimer_engine_batch_end(ctx);
+    flexitimer_write_end(ctx);
+    return FLEXITIMER_OK;
 }
 
-/* Delays the specified timer */
-flexitimer_error_t flexitimer_delay(timer_id_t id, timer_time_t delay)
+/* Cancels several timers */
+flexitimer_error_t flexitimer_ctx_cancel_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    flexitimer_error_t error = flexitimer_check_ids(ctx, ids, count);
+
+    if(error != FLEXITIMER_OK)
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        return error;
     }
 
-    if(timers[id].state != TIMER_STATE_PASSIVE)
+    flexitimer_write_begin(ctx);
+    flexitimer_engine_batch_begin(ctx, count);
+
+    for(uint32_t i = 0; i < count; i++)
     {
-        timers[id].remaining += delay;
-        return FLEXITIMER_OK;
+        flexitimer_apply_cancel(ctx, flexitimer_bulk_id(ids, i));
     }
 
-    return FLEXITIMER_ERROR_INVALID_STATE;
+    flexitimer_engine_batch_end(ctx);
+    flexitimer_write_end(ctx);
+    return FLEXITIMER_OK;
 }
 
-/* Pauses the specified timer */
-flexitimer_error_t flexitimer_pause(timer_id_t id)
+/* Checks that the counters of several timers hold a delay, once per occurrence of an id */
+static flexitimer_error_t flexitimer_check_delay_many(const flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_time_t delay)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    timer_time_t most = 0u;
+
+    for(uint32_t i = 0; i < count; i++)
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        timer_time_t remaining = flexitimer_timer_remaining(ctx, flexitimer_bulk_id(ids, i));
+        most = (remaining > most) ? remaining : most;
     }
 
-    if(timers[id].state == TIMER_STATE_ACTIVE)
+    /* Fits even if every id were the one with the most remaining time, repeated count times */
+    if(((uint64_t)delay * count) <= (uint64_t)(FLEXITIMER_COUNTER_MAX - most))
     {
-        timers[id].state = TIMER_STATE_PAUSED;
         return FLEXITIMER_OK;
     }
 
-    return FLEXITIMER_ERROR_INVALID_STATE;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        timer_id_t id = flexitimer_bulk_id(ids, i);
+        uint64_t repeats = 0u;
+
+        for(uint32_t j = 0; j < count; j++)
+        {
+            repeats += (flexitimer_bulk_id(ids, j) == id) ? 1u : 0u;
+        }
+
+        if(((uint64_t)delay * repeats) > (uint64_t)(FLEXITIMER_COUNTER_MAX - flexitimer_timer_remaining(ctx, id)))
+        {
+            return FLEXITIMER_ERROR_INVALID_ARG;
+        }
+    }
+
+    return FLEXITIMER_OK;
 }
 
-/* Resumes the specified timer */
-flexitimer_error_t flexitimer_resume(timer_id_t id)
+/* Delays several timers */
+flexitimer_error_t flexitimer_ctx_delay_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_time_t delay)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    flexitimer_error_t error = flexitimer_check_ids(ctx, ids, count);
+
+    if(error == FLEXITIMER_OK)
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        error = flexitimer_check_delay_many(ctx, ids, count, delay);
     }
 
-    if(timers[id].state == TIMER_STATE_PAUSED)
+    if(error != FLEXITIMER_OK)
     {
-        timers[id].state = TIMER_STATE_ACTIVE;
-        return FLEXITIMER_OK;
+        return error;
     }
 
-    return FLEXITIMER_ERROR_INVALID_STATE;
+    flexitimer_write_begin(ctx);
+    flexitimer_engine_batch_begin(ctx, count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        timer_id_t id = flexitimer_bulk_id(ids, i);
+        flexitimer_timer_t *timer = &ctx->timers[id];
+        flexitimer_group_sync(ctx, id);
+
+        if(timer->state == TIMER_STATE_PASSIVE)
+        {
+            error = FLEXITIMER_ERROR_INVALID_STATE;
+            continue;
+        }
+
+        /* A repeated id is delayed again, its counter was checked to hold all of them */
+        timer_time_t remaining = flexitimer_timer_remaining(ctx, id);
+
+        if(timer->state == TIMER_STATE_ACTIVE)
+        {
+            flexitimer_engine_disarm(ctx, id);
+            flexitimer_arm_ticks(ctx, id, remaining + delay);
+            flexitimer_trace(ctx, FLEXITIMER_TRACE_DELAY, id, delay);
+        }
+        else
+        {
+            timer->remaining += delay;
+            flexitimer_trace(ctx, FLEXITIMER_TRACE_DELAY, id, delay);
+        }
+    }
+
+    flexitimer_engine_batch_end(ctx);
+    flexitimer_write_end(ctx);
+    return error;
 }
 
-/* Restarts the specified timer */
-flexitimer_error_t flexitimer_restart(timer_id_t id)
+/* Gets the states and remaining times of several timers */
+flexitimer_error_t flexitimer_ctx_query_many(flexitimer_ctx_t *ctx, const timer_id_t *ids, uint32_t count, timer_state_t *states, timer_time_t *remaining)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    flexitimer_error_t error = flexitimer_check_ids(ctx, ids, count);
+
+    if(error != FLEXITIMER_OK)
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        return error;
     }
 
-    if(timers[id].callback != NULL)
+    for(uint32_t i = 0; i < count; i++)
     {
-        timers[id].remaining = timers[id].timeout;
-        timers[id].state = TIMER_STATE_ACTIVE;
-        return FLEXITIMER_OK;
+        timer_id_t id = flexitimer_bulk_id(ids, i);
+
+        if(states != NULL)
+        {
+            states[i] = flexitimer_timer_state(ctx, id);
+        }
+
+        if(remaining != NULL)
+        {
+            remaining[i] = flexitimer_timer_remaining(ctx, id);
+        }
     }
 
-    return FLEXITIMER_ERROR_INVALID_STATE;
+    return FLEXITIMER_OK;
 }
 
-/* Cancels the specified timer */
-flexitimer_error_t flexitimer_cancel(timer_id_t id)
+/* Sets the catch-up policy of the specified timer */
+flexitimer_error_t flexitimer_ctx_set_catchup(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_catchup_t policy)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
     {
         return FLEXITIMER_ERROR_INVALID_ID;
     }
 
-    timers[id].state = TIMER_STATE_PASSIVE;
-    timers[id].remaining = 0;
-    timers[id].callback = NULL;
+    if(policy > FLEXITIMER_CATCHUP_SKIP)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    ctx->timers[id].catchup = (uint8_t)policy;
     return FLEXITIMER_OK;
 }
 
-/* Gets the state of the specified timer */
-flexitimer_error_t flexitimer_get_state(timer_id_t id, timer_state_t *state)
+/* Sets the dispatch mode of the specified timer */
+flexitimer_error_t flexitimer_ctx_set_dispatch(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_dispatch_t mode)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
     {
         return FLEXITIMER_ERROR_INVALID_ID;
     }
 
-    if(state == NULL)
+    if(mode > FLEXITIMER_DISPATCH_DEFERRED)
     {
         return FLEXITIMER_ERROR_INVALID_ARG;
     }
 
-    *state = timers[id].state;
+    ctx->timers[id].dispatch = (uint8_t)mode;
     return FLEXITIMER_OK;
 }
 
-/* Gets the type of the specified timer */
-flexitimer_error_t flexitimer_get_type(timer_id_t id, timer_type_t *type)
+#if FLEXITIMER_PRIORITIES
+/* Sets the priority class of the specified timer */
+flexitimer_error_t flexitimer_ctx_set_priority(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_priority_t priority)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
     {
         return FLEXITIMER_ERROR_INVALID_ID;
     }
 
-    if(type == NULL)
+    if(priority > FLEXITIMER_PRIORITY_IDLE)
     {
         return FLEXITIMER_ERROR_INVALID_ARG;
     }
 
-    *type = timers[id].type;
+    flexitimer_timer_t *timer = &ctx->timers[id];
+    uint8_t pending = timer->pending;
+
+    /* A waiting callback moves from the queue of the old class to the tail of the new one */
+    if((pending & PENDING_QUEUED) != 0u)
+    {
+        flexitimer_unqueue(ctx, id);
+    }
+
+    timer->priority = (uint8_t)priority;
+    timer->pending = 0;
+
+    if((pending & PENDING_LIVE) != 0u)
+    {
+        timer_time_t since = timer->pending_since;
+        flexitimer_enqueue(ctx, id);
+        timer->pending_since = since;
+    }
+
     return FLEXITIMER_OK;
 }
 
-/* Gets the original timeout of the specified timer */
-flexitimer_error_t flexitimer_get_time(timer_id_t id, timer_time_t *time)
+/* Sets the dispatch budget of the handler calls of a context */
+flexitimer_error_t flexitimer_ctx_set_budget(flexitimer_ctx_t *ctx, uint32_t callbacks, uint64_t time, flexitimer_clock_t clock)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    if((ctx == NULL) || ((time != 0u) && (clock == NULL)))
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        return FLEXITIMER_ERROR_INVALID_ARG;
     }
 
-    if(time == NULL)
+    ctx->budget_callbacks = callbacks;
+    ctx->budget_time = time;
+    ctx->budget_clock = clock;
+    ctx->budget_used = 0;
+    ctx->budget_start = 0;
+    return FLEXITIMER_OK;
+}
+
+/* Gets the dispatch statistics of a priority class */
+flexitimer_error_t flexitimer_ctx_get_class_stats(const flexitimer_ctx_t *ctx, flexitimer_priority_t priority, flexitimer_class_stats_t *stats)
+{
+    if((ctx == NULL) || (priority > FLEXITIMER_PRIORITY_IDLE) || (stats == NULL))
     {
         return FLEXITIMER_ERROR_INVALID_ARG;
     }
 
-    *time = timers[id].timeout;
+    const flexitimer_class_t *queue = &ctx->classes[priority];
+    *stats = queue->stats;
+    stats->waiting = 0;
+    stats->oldest = 0;
+
+    for(flexitimer_node_t node = queue->head; node != NODE_NONE; node = ctx->timers[node].pending_next)
+    {
+        const flexitimer_timer_t *timer = &ctx->timers[node];
+
+        if((timer->pending & PENDING_LIVE) != 0u)
+        {
+            timer_time_t wait = ctx->now - timer->pending_since;
+            stats->waiting++;
+            stats->oldest = (wait > stats->oldest) ? wait : stats->oldest;
+        }
+    }
+
     return FLEXITIMER_OK;
 }
 
-/* Gets the remaining time of the specified timer */
-flexitimer_error_t flexitimer_get_elapsed(timer_id_t id, timer_time_t *time)
+/* Resets the dispatch statistics of all priority classes of a context */
+void flexitimer_ctx_reset_class_stats(flexitimer_ctx_t *ctx)
 {
-    if(id >= FLEXITIMER_MAX_TIMERS)
+    if(ctx != NULL)
     {
-        return FLEXITIMER_ERROR_INVALID_ID;
+        for(uint32_t i = 0; i < FLEXITIMER_PRIORITY_CLASSES; i++)
+        {
+            ctx->classes[i].stats.dispatched = 0;
+            ctx->classes[i].stats.carried = 0;
+            ctx->classes[i].stats.coalesced = 0;
+            ctx->classes[i].stats.max_wait = 0;
+            ctx->classes[i].stats.waiting = 0;
+            ctx->classes[i].stats.oldest = 0;
+        }
     }
+}
+#endif
 
-    if(time == NULL)
+/* Sets the executor of the deferred timers of a context */
+void flexitimer_ctx_set_dispatcher(flexitimer_ctx_t *ctx, const flexitimer_dispatcher_t *dispatcher)
+{
+    if(ctx != NULL)
+    {
+        ctx->dispatcher.submit = (dispatcher != NULL) ? dispatcher->submit : NULL;
+        ctx->dispatcher.flush = (dispatcher != NULL) ? dispatcher->flush : NULL;
+        ctx->dispatcher.arg = (dispatcher != NULL) ? dispatcher->arg : NULL;
+    }
+}
+
+#if FLEXITIMER_CALLBACK_TABLE
+/* Sets the callback table of a context */
+flexitimer_error_t flexitimer_ctx_set_callbacks(flexitimer_ctx_t *ctx, const timer_callback_t *callbacks, uint32_t count)
+{
+    if((ctx == NULL) || ((callbacks == NULL) && (count > 0u)) || (count > UINT8_MAX))
     {
         return FLEXITIMER_ERROR_INVALID_ARG;
     }
 
-    *time = timers[id].remaining;
+    ctx->callbacks = callbacks;
+    ctx->callback_count = count;
     return FLEXITIMER_OK;
 }
+#endif
+
+/* Gets the default scheduler context */
+flexitimer_ctx_t *flexitimer_default_ctx(void)
+{
+    return &default_ctx;
+}
+
+/* Initializes the scheduler */
+void flexitimer_init(void)
+{
+    (void)flexitimer_ctx_init(&default_ctx, default_timers, FLEXITIMER_MAX_TIMERS);
+}
+
+/* Starts a timer with the specified parameters */
+flexitimer_error_t flexitimer_start(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    return flexitimer_ctx_start(&default_ctx, id, type, timeout, callback);
+}
+
+/* Starts a timer with a slack window */
+flexitimer_error_t flexitimer_start_ex(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_time_t slack, timer_callback_t callback)
+{
+    return flexitimer_ctx_start_ex(&default_ctx, id, type, timeout, slack, callback);
+}
+
+/* Handler function to be called in a loop */
+void flexitimer_handler(void)
+{
+    flexitimer_ctx_handler(&default_ctx);
+}
+
+/* Processes several elapsed ticks at once */
+void flexitimer_advance(timer_time_t ticks)
+{
+    flexitimer_ctx_advance(&default_ctx, ticks);
+}
+
+/* Gets the ticks until the earliest expiry */
+flexitimer_error_t flexitimer_next_expiry(timer_time_t *ticks)
+{
+    return flexitimer_ctx_next_expiry(&default_ctx, ticks);
+}
+
+/* Gets the ticks processed since the initialization */
+flexitimer_error_t flexitimer_get_now(timer_time_t *now)
+{
+    return flexitimer_ctx_get_now(&default_ctx, now);
+}
+
+/* Delays the specified timer */
+flexitimer_error_t flexitimer_delay(timer_id_t id, timer_time_t delay)
+{
+    return flexitimer_ctx_delay(&default_ctx, id, delay);
+}
+
+/* Pauses the specified timer */
+flexitimer_error_t flexitimer_pause(timer_id_t id)
+{
+    return flexitimer_ctx_pause(&default_ctx, id);
+}
+
+/* Resumes the specified timer */
+flexitimer_error_t flexitimer_resume(timer_id_t id)
+{
+    return flexitimer_ctx_resume(&default_ctx, id);
+}
+
+/* Restarts the specified timer */
+flexitimer_error_t flexitimer_restart(timer_id_t id)
+{
+    return flexitimer_ctx_restart(&default_ctx, id);
+}
+
+/* Cancels the specified timer */
+flexitimer_error_t flexitimer_cancel(timer_id_t id)
+{
+    return flexitimer_ctx_cancel(&default_ctx, id);
+}
+
+/* Gets the state of the specified timer */
+flexitimer_error_t flexitimer_get_state(timer_id_t id, timer_state_t *state)
+{
+    return flexitimer_ctx_get_state(&default_ctx, id, state);
+}
+
+/* Gets the type of the specified timer */
+flexitimer_error_t flexitimer_get_type(timer_id_t id, timer_type_t *type)
+{
+    return flexitimer_ctx_get_type(&default_ctx, id, type);
+}
+
+/* Gets the original timeout of the specified timer */
+flexitimer_error_t flexitimer_get_time(timer_id_t id, timer_time_t *time)
+{
+    return flexitimer_ctx_get_time(&default_ctx, id, time);
+}
+
+/* Gets the remaining time of the specified timer */
+flexitimer_error_t flexitimer_get_elapsed(timer_id_t id, timer_time_t *time)
+{
+    return flexitimer_ctx_get_elapsed(&default_ctx, id, time);
+}
+
+/* Starts several timers with the same parameters */
+flexitimer_error_t flexitimer_start_many(const timer_id_t *ids, uint32_t count, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    return flexitimer_ctx_start_many(&default_ctx, ids, count, type, timeout, callback);
+}
+
+/* Cancels several timers */
+flexitimer_error_t flexitimer_cancel_many(const timer_id_t *ids, uint32_t count)
+{
+    return flexitimer_ctx_cancel_many(&default_ctx, ids, count);
+}
+
+/* Delays several timers */
+flexitimer_error_t flexitimer_delay_many(const timer_id_t *ids, uint32_t count, timer_time_t delay)
+{
+    return flexitimer_ctx_delay_many(&default_ctx, ids, count, delay);
+}
+
+/* Gets the states and remaining times of several timers */
+flexitimer_error_t flexitimer_query_many(const timer_id_t *ids, uint32_t count, timer_state_t *states, timer_time_t *remaining)
+{
+    return flexitimer_ctx_query_many(&default_ctx, ids, count, states, remaining);
+}
+
+/* Sets the catch-up policy of the specified timer */
+flexitimer_error_t flexitimer_set_catchup(timer_id_t id, flexitimer_catchup_t policy)
+{
+    return flexitimer_ctx_set_catchup(&default_ctx, id, policy);
+}
+
+/* Sets the dispatch mode of the specified timer */
+flexitimer_error_t flexitimer_set_dispatch(timer_id_t id, flexitimer_dispatch_t mode)
+{
+    return flexitimer_ctx_set_dispatch(&default_ctx, id, mode);
+}
+
+#if FLEXITIMER_PRIORITIES
+/* Sets the priority class of the specified timer */
+flexitimer_error_t flexitimer_set_priority(timer_id_t id, flexitimer_priority_t priority)
+{
+    return flexitimer_ctx_set_priority(&default_ctx, id, priority);
+}
+
+/* Sets the dispatch budget of the handler calls of the default context */
+flexitimer_error_t flexitimer_set_budget(uint32_t callbacks, uint64_t time, flexitimer_clock_t clock)
+{
+    return flexitimer_ctx_set_budget(&default_ctx, callbacks, time, clock);
+}
+
+/* Gets the dispatch statistics of a priority class of the default context */
+flexitimer_error_t flexitimer_get_class_stats(flexitimer_priority_t priority, flexitimer_class_stats_t *stats)
+{
+    return flexitimer_ctx_get_class_stats(&default_ctx, priority, stats);
+}
+
+/* Resets the dispatch statistics of the default context */
+void flexitimer_reset_class_stats(void)
+{
+    flexitimer_ctx_reset_class_stats(&default_ctx);
+}
+#endif
+
+/* Sets the executor of the deferred timers of the default context */
+void flexitimer_set_dispatcher(const flexitimer_dispatcher_t *dispatcher)
+{
+    flexitimer_ctx_set_dispatcher(&default_ctx, dispatcher);
+}
+
+#if FLEXITIMER_CALLBACK_TABLE
+/* Sets the callback table of the default context */
+flexitimer_error_t flexitimer_set_callbacks(const timer_callback_t *callbacks, uint32_t count)
+{
+    return flexitimer_ctx_set_callbacks(&default_ctx, callbacks, count);
+}
+#endif
+
+/* Sets the time source of the default context */
+void flexitimer_set_time_source(flexitimer_time_source_t source)
+{
+    flexitimer_ctx_set_time_source(&default_ctx, source);
+}
+
+/* Processes the ticks elapsed on the time source */
+void flexitimer_poll(void)
+{
+    flexitimer_ctx_poll(&default_ctx);
+}
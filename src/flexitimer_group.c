@@ -0,0 +1,207 @@
+/**
+    @file flexitimer_group.c
+    @brief FlexiTimer Scheduler Library - timer groups
+
+    A group operation only updates the group record, its members pick the change up lazily.
+    A pause or delay holds the group clock back, a member armed before compares the lag of the
+    group with the lag it was armed at when the engine expires it, and is armed again for the
+    difference instead of firing. A cancel counts up the epoch of the group, members of an
+    older epoch are PASSIVE and are dropped when they expire or are touched next. The engines
+    only ever see members expiring at or before their deadline, whichever engine is in use.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+#include <stdio.h> // for NULL
+
+#if FLEXITIMER_GROUPS
+
+/* Gets a group of a context, NULL if it does not exist */
+static flexitimer_group_t *group_get(const flexitimer_ctx_t *ctx, uint32_t group)
+{
+    return ((ctx != NULL) && (group < ctx->group_count)) ? &ctx->groups[group] : NULL;
+}
+
+/* Gets the error of a group that does not exist */
+static flexitimer_error_t group_error(const flexitimer_ctx_t *ctx)
+{
+    return (ctx == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+}
+
+/* Sets the timer groups of a context */
+flexitimer_error_t flexitimer_ctx_set_groups(flexitimer_ctx_t *ctx, flexitimer_group_t *groups, uint32_t count)
+{
+    if((ctx == NULL) || ((groups == NULL) && (count > 0u)) || (count > UINT8_MAX))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    flexitimer_write_begin(ctx);
+
+    for(uint32_t i = 0; i < ctx->capacity; i++)
+    {
+        ctx->timers[i].group = 0;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        groups[i].lag = 0;
+        groups[i].paused_at = 0;
+        groups[i].epoch = 0;
+        groups[i].paused = 0;
+    }
+
+    ctx->groups = groups;
+    ctx->group_count = count;
+    flexitimer_write_end(ctx);
+    return FLEXITIMER_OK;
+}
+
+/* Starts a timer as a member of a group */
+flexitimer_error_t flexitimer_ctx_start_in_group(flexitimer_ctx_t *ctx, timer_id_t id, uint32_t group, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    flexitimer_group_t *entry = group_get(ctx, group);
+
+    if(entry == NULL)
+    {
+        return group_error(ctx);
+    }
+
+    flexitimer_write_begin(ctx);
+    flexitimer_error_t error = flexitimer_ctx_start(ctx, id, type, timeout, callback);
+
+    if(error == FLEXITIMER_OK)
+    {
+        /* Armed on the group clock as it stands now */
+        flexitimer_timer_t *timer = &ctx->timers[id];
+        timer->group = (uint8_t)(group + 1u);
+        timer->group_epoch = entry->epoch;
+        timer->group_lag = flexitimer_group_lag(ctx, entry);
+    }
+
+    flexitimer_write_end(ctx);
+    return error;
+}
+
+/* Pauses all timers of a group */
+flexitimer_error_t flexitimer_ctx_group_pause(flexitimer_ctx_t *ctx, uint32_t group)
+{
+    flexitimer_group_t *entry = group_get(ctx, group);
+
+    if(entry == NULL)
+    {
+        return group_error(ctx);
+    }
+
+    if(entry->paused != 0u)
+    {
+        return FLEXITIMER_ERROR_INVALID_STATE;
+    }
+
+    flexitimer_write_begin(ctx);
+    entry->paused_at = ctx->now;
+    entry->paused = 1u;
+    flexitimer_write_end(ctx);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_GROUP_PAUSE, group, 0u);
+    return FLEXITIMER_OK;
+}
+
+/* Resumes all timers of a group */
+flexitimer_error_t flexitimer_ctx_group_resume(flexitimer_ctx_t *ctx, uint32_t group)
+{
+    flexitimer_group_t *entry = group_get(ctx, group);
+
+    if(entry == NULL)
+    {
+        return group_error(ctx);
+    }
+
+    if(entry->paused == 0u)
+    {
+        return FLEXITIMER_ERROR_INVALID_STATE;
+    }
+
+    flexitimer_write_begin(ctx);
+    entry->lag += ctx->now - entry->paused_at;
+    entry->paused = 0u;
+    flexitimer_write_end(ctx);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_GROUP_RESUME, group, 0u);
+    return FLEXITIMER_OK;
+}
+
+/* Cancels all timers of a group */
+flexitimer_error_t flexitimer_ctx_group_cancel(flexitimer_ctx_t *ctx, uint32_t group)
+{
+    flexitimer_group_t *entry = group_get(ctx, group);
+
+    if(entry == NULL)
+    {
+        return group_error(ctx);
+    }
+
+    flexitimer_write_begin(ctx);
+    entry->epoch++;
+    flexitimer_write_end(ctx);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_GROUP_CANCEL, group, 0u);
+    return FLEXITIMER_OK;
+}
+
+/* Delays all active timers of a group */
+flexitimer_error_t flexitimer_ctx_group_delay(flexitimer_ctx_t *ctx, uint32_t group, timer_time_t delay)
+{
+    flexitimer_group_t *entry = group_get(ctx, group);
+
+    if(entry == NULL)
+    {
+        return group_error(ctx);
+    }
+
+    flexitimer_write_begin(ctx);
+    entry->lag += delay;
+    flexitimer_write_end(ctx);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_GROUP_DELAY, group, delay);
+    return FLEXITIMER_OK;
+}
+
+/* Sets the timer groups of the default context */
+flexitimer_error_t flexitimer_set_groups(flexitimer_group_t *groups, uint32_t count)
+{
+    return flexitimer_ctx_set_groups(flexitimer_default_ctx(), groups, count);
+}
+
+/* Starts a timer of the default context as a member of a group */
+flexitimer_error_t flexitimer_start_in_group(timer_id_t id, uint32_t group, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    return flexitimer_ctx_start_in_group(flexitimer_default_ctx(), id, group, type, timeout, callback);
+}
+
+/* Pauses all timers of a group of the default context */
+flexitimer_error_t flexitimer_group_pause(uint32_t group)
+{
+    return flexitimer_ctx_group_pause(flexitimer_default_ctx(), group);
+}
+
+/* Resumes all timers of a group of the default context */
+flexitimer_error_t flexitimer_group_resume(uint32_t group)
+{
+    return flexitimer_ctx_group_resume(flexitimer_default_ctx(), group);
+}
+
+/* Cancels all timers of a group of the default context */
+flexitimer_error_t flexitimer_group_cancel(uint32_t group)
+{
+    return flexitimer_ctx_group_cancel(flexitimer_default_ctx(), group);
+}
+
+/* Delays all active timers of a group of the default context */
+flexitimer_error_t flexitimer_group_delay(uint32_t group, timer_time_t delay)
+{
+    return flexitimer_ctx_group_delay(flexitimer_default_ctx(), group, delay);
+}
+
+#endif // FLEXITIMER_GROUPS
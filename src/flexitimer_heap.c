@@ -0,0 +1,203 @@
+/**
+    @file flexitimer_heap.c
+    @brief FlexiTimer Scheduler Library - deadline min-heap engine
+
+    Active timers are kept in a binary min-heap ordered by their absolute deadline against a
+    global tick counter, ties broken by timer id. Nothing is counted down per timer: a tick
+    compares the heap top with the counter and pops only the due timers.
+    Arming and disarming are O(log n), the next expiry is O(1). A bulk operation on a large
+    share of the timers appends and removes entries unordered and rebuilds the heap once, O(n).
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+
+#if FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_HEAP
+
+/* The heap array is spread over the timer records, entry i lives in timers[i].heap */
+#define HEAP(i) (ctx->timers[(i)].heap)
+
+/* Deadlines are compared relative to the counter, so wrap-around is harmless */
+static int heap_before(const flexitimer_ctx_t *ctx, const flexitimer_heap_entry_t *a, const flexitimer_heap_entry_t *b)
+{
+    timer_time_t da = a->deadline - ctx->now;
+    timer_time_t db = b->deadline - ctx->now;
+    return (da < db) || ((da == db) && (a->id < b->id));
+}
+
+static void heap_place(flexitimer_ctx_t *ctx, flexitimer_node_t position, flexitimer_heap_entry_t entry)
+{
+    HEAP(position) = entry;
+    ctx->timers[entry.id].position = position;
+}
+
+static void heap_sift_up(flexitimer_ctx_t *ctx, flexitimer_node_t position, flexitimer_heap_entry_t entry)
+{
+    while(position > 0u)
+    {
+        flexitimer_node_t parent = (position - 1u) / 2u;
+
+        if(!heap_before(ctx, &entry, &HEAP(parent)))
+        {
+            break;
+        }
+
+        heap_place(ctx, position, HEAP(parent));
+        position = parent;
+    }
+
+    heap_place(ctx, position, entry);
+}
+
+static void heap_sift_down(flexitimer_ctx_t *ctx, flexitimer_node_t position, flexitimer_heap_entry_t entry)
+{
+    for(;;)
+    {
+        flexitimer_node_t child = (position * 2u) + 1u;
+
+        if(child >= ctx->count)
+        {
+            break;
+        }
+
+        if(((child + 1u) < ctx->count) && heap_before(ctx, &HEAP(child + 1u), &HEAP(child)))
+        {
+            child++;
+        }
+
+        if(!heap_before(ctx, &HEAP(child), &entry))
+        {
+            break;
+        }
+
+        heap_place(ctx, position, HEAP(child));
+        position = child;
+    }
+
+    heap_place(ctx, position, entry);
+}
+
+/* Restores the heap order of all entries, bottom-up */
+static void heap_build(flexitimer_ctx_t *ctx)
+{
+    for(flexitimer_node_t position = ctx->count / 2u; position > 0u; position--)
+    {
+        heap_sift_down(ctx, position - 1u, HEAP(position - 1u));
+    }
+}
+
+/* Resets the engine */
+void flexitimer_engine_init(flexitimer_ctx_t *ctx)
+{
+    ctx->count = 0;
+    ctx->batch = 0;
+    ctx->now = 0;
+}
+
+/* Arms a timer */
+void flexitimer_engine_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    flexitimer_heap_entry_t entry;
+    ctx->timers[id].expiry = ctx->now + ticks;
+    ctx->timers[id].remaining = ticks;
+    entry.deadline = (ticks == 0u) ? (ctx->now + 1u) : ctx->timers[id].expiry;
+    entry.id = id;
+    ctx->count++;
+
+    if(ctx->batch != 0u)
+    {
+        heap_place(ctx, ctx->count - 1u, entry);
+    }
+    else
+    {
+        heap_sift_up(ctx, ctx->count - 1u, entry);
+    }
+}
+
+/* Disarms a timer */
+void flexitimer_engine_disarm(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    flexitimer_node_t position = ctx->timers[id].position;
+    flexitimer_heap_entry_t last;
+    ctx->count--;
+
+    if(position != ctx->count)
+    {
+        last = HEAP(ctx->count);
+
+        if(ctx->batch != 0u)
+        {
+            heap_place(ctx, position, last);
+        }
+        else if((position > 0u) && heap_before(ctx, &last, &HEAP((position - 1u) / 2u)))
+        {
+            heap_sift_up(ctx, position, last);
+        }
+        else
+        {
+            heap_sift_down(ctx, position, last);
+        }
+    }
+}
+
+/* Gets the remaining ticks of a timer */
+timer_time_t flexitimer_engine_remaining(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    /* A timer armed with 0 ticks is due on the next tick and reports 0 until it expires */
+    return (ctx->timers[id].remaining == 0u) ? 0u : (ctx->timers[id].expiry - ctx->now);
+}
+
+/* Advances one tick */
+void flexitimer_engine_tick(flexitimer_ctx_t *ctx)
+{
+    ctx->now++;
+
+    /* Timers re-armed by the callbacks are due on a later tick at the earliest */
+    while((ctx->count > 0u) && (HEAP(0).deadline == ctx->now))
+    {
+        timer_id_t id = HEAP(0).id;
+        flexitimer_engine_disarm(ctx, id);
+        flexitimer_expire(ctx, id);
+    }
+}
+
+/* Gets the ticks until the next expiry */
+timer_time_t flexitimer_engine_next(flexitimer_ctx_t *ctx)
+{
+    /* Members of a cancelled group are dropped from the top instead of waking the caller */
+    while((ctx->count > 0u) && (flexitimer_group_cancelled(ctx, HEAP(0).id) != 0))
+    {
+        flexitimer_group_sync(ctx, HEAP(0).id);
+    }
+
+    return (ctx->count > 0u) ? (HEAP(0).deadline - ctx->now) : 0u;
+}
+
+/* Skips ticks without expiries */
+void flexitimer_engine_skip(flexitimer_ctx_t *ctx, timer_time_t ticks)
+{
+    ctx->now += ticks;
+}
+
+/* Starts a batch, one of at least an eighth of the heap size leaves the order to its end */
+void flexitimer_engine_batch_begin(flexitimer_ctx_t *ctx, uint32_t count)
+{
+    ctx->batch = (count >= (ctx->count / 8u)) ? 1u : 0u;
+}
+
+/* Ends a batch */
+void flexitimer_engine_batch_end(flexitimer_ctx_t *ctx)
+{
+    if(ctx->batch != 0u)
+    {
+        ctx->batch = 0;
+        heap_build(ctx);
+    }
+}
+
+#endif // FLEXITIMER_ENGINE_HEAP
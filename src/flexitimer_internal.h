@@ -0,0 +1,334 @@
+/**
+    @file flexitimer_internal.h
+    @brief FlexiTimer Scheduler Library - internal definitions
+
+    Private interface between the public API in flexitimer.c and the timer engines.
+    An engine owns the "when does it expire" bookkeeping of ACTIVE timers, the core owns
+    the timer records, states and the callbacks.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#ifndef FLEXITIMER_INTERNAL_H
+#define FLEXITIMER_INTERNAL_H
+
+#include "flexitimer.h"
+#include <stddef.h>
+
+/**
+    @brief Called by the engine for every timer that expires, in ascending id order per tick.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+*/
+void flexitimer_expire(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Cancels a timer whose group was cancelled after its start, the cancel reaches the
+    members lazily. Does nothing for other timers.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+*/
+void flexitimer_group_sync(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Resets the engine bookkeeping. No timer is armed afterwards.
+    @param ctx Scheduler context.
+*/
+void flexitimer_engine_init(flexitimer_ctx_t *ctx);
+
+/**
+    @brief Arms an ACTIVE timer to expire after the given number of ticks.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+    @param ticks Remaining ticks, 0 expires on the next tick.
+*/
+void flexitimer_engine_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks);
+
+/**
+    @brief Removes an armed timer from the engine.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+*/
+void flexitimer_engine_disarm(flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Gets the remaining ticks of an armed timer.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+    @return Remaining ticks.
+*/
+timer_time_t flexitimer_engine_remaining(const flexitimer_ctx_t *ctx, timer_id_t id);
+
+/**
+    @brief Advances the engine by one tick and expires the due timers.
+    @param ctx Scheduler context.
+*/
+void flexitimer_engine_tick(flexitimer_ctx_t *ctx);
+
+/**
+    @brief Gets the number of ticks until the earliest armed timer expires.
+    @param ctx Scheduler context.
+    @return Ticks until the next expiry (at least 1), 0 if no timer is armed.
+*/
+timer_time_t flexitimer_engine_next(flexitimer_ctx_t *ctx);
+
+/**
+    @brief Advances the engine by the given number of ticks in which no timer expires.
+    @param ctx Scheduler context.
+    @param ticks Ticks to skip, less than the value returned by flexitimer_engine_next().
+*/
+void flexitimer_engine_skip(flexitimer_ctx_t *ctx, timer_time_t ticks);
+
+/**
+    @brief Starts a batch of arms and disarms of a bulk operation. The engine may defer its
+    index updates to flexitimer_engine_batch_end(), nothing but arms and disarms is called
+    in between.
+    @param ctx Scheduler context.
+    @param count Number of timers of the operation.
+*/
+void flexitimer_engine_batch_begin(flexitimer_ctx_t *ctx, uint32_t count);
+
+/**
+    @brief Ends a batch of arms and disarms.
+    @param ctx Scheduler context.
+*/
+void flexitimer_engine_batch_end(flexitimer_ctx_t *ctx);
+
+/**
+    @brief Gets the index of the lowest set bit.
+    @param bits Non-zero bit set.
+    @return Bit index.
+*/
+static inline uint32_t flexitimer_ctz64(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(bits);
+#else
+    uint32_t index = 0;
+
+    while((bits & 1u) == 0u)
+    {
+        bits >>= 1u;
+        index++;
+    }
+
+    return index;
+#endif
+}
+
+/**
+    @brief Gets the default scheduler context.
+    @return Default context.
+*/
+flexitimer_ctx_t *flexitimer_default_ctx(void);
+
+#if FLEXITIMER_SNAPSHOT && !defined(__GNUC__)
+#error "The snapshots require the GCC/Clang __atomic builtins"
+#endif
+
+#if FLEXITIMER_TRACE && !defined(__GNUC__)
+#error "The event trace requires the GCC/Clang __atomic builtins"
+#endif
+
+/**
+    @brief Starts an update of the timers of a context, nested updates share the outer one.
+    Snapshot readers retry while the sequence is odd.
+    @param ctx Scheduler context.
+*/
+static inline void flexitimer_write_begin(flexitimer_ctx_t *ctx)
+{
+#if FLEXITIMER_SNAPSHOT
+    if(ctx->write_depth == 0u)
+    {
+        __atomic_store_n(&ctx->sequence, ctx->sequence + 1u, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE); // the odd sequence is visible before the update
+    }
+
+    ctx->write_depth++;
+#else
+    (void)ctx;
+#endif
+}
+
+/**
+    @brief Ends an update of the timers of a context.
+    @param ctx Scheduler context.
+*/
+static inline void flexitimer_write_end(flexitimer_ctx_t *ctx)
+{
+#if FLEXITIMER_SNAPSHOT
+    ctx->write_depth--;
+
+    if(ctx->write_depth == 0u)
+    {
+        __atomic_store_n(&ctx->sequence, ctx->sequence + 1u, __ATOMIC_RELEASE);
+    }
+#else
+    (void)ctx;
+#endif
+}
+
+/**
+    @brief Records an event in the trace buffer of a context, if one is set.
+    @param ctx Scheduler context.
+    @param type Event type.
+    @param id Timer identifier, or group index of the group events.
+    @param value Event value.
+*/
+static inline void flexitimer_trace(flexitimer_ctx_t *ctx, flexitimer_trace_type_t type, uint32_t id, timer_time_t value)
+{
+#if FLEXITIMER_TRACE
+    if(ctx->trace != NULL)
+    {
+        uint32_t head = ctx->trace_head;
+        flexitimer_trace_event_t *event = &ctx->trace[head & ctx->trace_mask];
+        event->clock = (ctx->trace_clock != NULL) ? ctx->trace_clock() : 0u;
+        event->tick = ctx->now;
+        event->id = id;
+        event->value = value;
+        event->type = (uint8_t)type;
+        __atomic_store_n(&ctx->trace_head, head + 1u, __ATOMIC_RELEASE); // publishes the event to readers
+    }
+#else
+    (void)ctx;
+    (void)type;
+    (void)id;
+    (void)value;
+#endif
+}
+
+#if FLEXITIMER_GROUPS
+
+/**
+    @brief Gets how far the clock of a group runs behind the ticks of the context.
+    @param ctx Scheduler context.
+    @param group Timer group.
+    @return Lag in ticks, growing with the delays and while the group is paused.
+*/
+static inline timer_time_t flexitimer_group_lag(const flexitimer_ctx_t *ctx, const flexitimer_group_t *group)
+{
+    return group->lag + ((group->paused != 0u) ? (ctx->now - group->paused_at) : 0u);
+}
+
+#endif // FLEXITIMER_GROUPS
+
+/**
+    @brief Checks whether the group of a timer was cancelled after its start.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+    @return 1 if the timer is a member of a cancelled group, 0 otherwise.
+*/
+static inline int flexitimer_group_cancelled(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+#if FLEXITIMER_GROUPS
+    const flexitimer_timer_t *timer = &ctx->timers[id];
+    return (timer->group != 0u) && (timer->group_epoch != ctx->groups[timer->group - 1u].epoch);
+#else
+    (void)ctx;
+    (void)id;
+    return 0;
+#endif
+}
+
+/**
+    @brief Gets the state of a timer as the API reports it, the ACTIVE members of a paused
+    group are PAUSED and the members of a cancelled group PASSIVE.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+    @return Timer state.
+*/
+static inline timer_state_t flexitimer_timer_state(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    const flexitimer_timer_t *timer = &ctx->timers[id];
+    timer_state_t state = (timer_state_t)timer->state;
+#if FLEXITIMER_GROUPS
+    if(timer->group != 0u)
+    {
+        const flexitimer_group_t *group = &ctx->groups[timer->group - 1u];
+
+        if(timer->group_epoch != group->epoch)
+        {
+            state = TIMER_STATE_PASSIVE;
+        }
+        else if((state == TIMER_STATE_ACTIVE) && (group->paused != 0u))
+        {
+            state = TIMER_STATE_PAUSED;
+        }
+    }
+#endif
+    return state;
+}
+
+/**
+    @brief Gets the remaining time of a timer as the API reports it, including the lag its
+    group gained since the timer was armed.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+    @return Remaining ticks.
+*/
+static inline timer_time_t flexitimer_timer_remaining(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    const flexitimer_timer_t *timer = &ctx->timers[id];
+    timer_time_t remaining = (timer->state == TIMER_STATE_ACTIVE) ? flexitimer_engine_remaining(ctx, id) : timer->remaining;
+#if FLEXITIMER_GROUPS
+    if(timer->group != 0u)
+    {
+        const flexitimer_group_t *group = &ctx->groups[timer->group - 1u];
+
+        if(timer->group_epoch != group->epoch)
+        {
+            remaining = 0u;
+        }
+        else if(timer->state == TIMER_STATE_ACTIVE)
+        {
+            remaining += flexitimer_group_lag(ctx, group) - timer->group_lag;
+        }
+    }
+#endif
+    return remaining;
+}
+
+#if FLEXITIMER_HANDLES
+
+/**
+    @brief Puts all timers of a context into the free pool.
+    @param ctx Scheduler context.
+*/
+void flexitimer_pool_init(flexitimer_ctx_t *ctx);
+
+#endif // FLEXITIMER_HANDLES
+
+#if FLEXITIMER_STATS
+
+/**
+    @brief Accounts one expiration of a timer.
+    @param ctx Scheduler context.
+    @param id Timer identifier.
+    @param duration Callback duration in clock units.
+*/
+void flexitimer_stats_record(flexitimer_ctx_t *ctx, timer_id_t id, uint64_t duration);
+
+#endif // FLEXITIMER_STATS
+
+#if FLEXITIMER_QUEUE_SIZE > 0
+
+/**
+    @brief Resets the command queue of a context.
+    @param ctx Scheduler context.
+*/
+void flexitimer_queue_init(flexitimer_ctx_t *ctx);
+
+/**
+    @brief Applies the queued commands of a context, called by the handler thread.
+    @param ctx Scheduler context.
+    @return Number of commands applied.
+*/
+uint32_t flexitimer_queue_drain(flexitimer_ctx_t *ctx);
+
+#endif // FLEXITIMER_QUEUE_SIZE
+
+#endif // FLEXITIMER_INTERNAL_H
@@ -0,0 +1,389 @@
+/**
+    @file flexitimer_linux.c
+    @brief FlexiTimer Scheduler Library - Linux timerfd driver
+
+    The timerfd is armed with an absolute CLOCK_MONOTONIC time, the deadline of the earliest
+    timer computed from the tick origin, so the wakeups do not accumulate drift. A dispatch
+    advances the context by all ticks elapsed since the previous one.
+
+    The tick thread sleeps to an absolute deadline as well, minus the spin window, and keeps
+    the jitter of its wakeups in a histogram of 8 linear buckets per power of two.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // pthread_attr_setaffinity_np
+#endif
+
+#include "flexitimer_linux.h"
+#include "flexitimer_internal.h"
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NS_PER_SEC (1000000000u)
+
+/* Reads CLOCK_MONOTONIC in nanoseconds */
+static uint64_t linux_now_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * NS_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
+
+/* Arms the timerfd for an absolute time, 0 disarms it */
+static flexitimer_error_t linux_settime(const flexitimer_linux_t *driver, uint64_t when_ns)
+{
+    struct itimerspec spec = {0};
+    spec.it_value.tv_sec = (time_t)(when_ns / NS_PER_SEC);
+    spec.it_value.tv_nsec = (long)(when_ns % NS_PER_SEC);
+    return (timerfd_settime(driver->fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0) ? FLEXITIMER_OK : FLEXITIMER_ERROR_SYSTEM;
+}
+
+/* Initializes a driver */
+flexitimer_error_t flexitimer_linux_init(flexitimer_linux_t *driver, flexitimer_ctx_t *ctx, uint64_t tick_ns)
+{
+    if((driver == NULL) || (tick_ns == 0u))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    driver->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if(driver->fd < 0)
+    {
+        return FLEXITIMER_ERROR_SYSTEM;
+    }
+
+    driver->ctx = (ctx != NULL) ? ctx : flexitimer_default_ctx();
+    driver->tick_ns = tick_ns;
+    driver->origin_ns = linux_now_ns();
+    driver->ticks = 0;
+    driver->running = 1u;
+    driver->wakeup = 0u;
+    return flexitimer_linux_rearm(driver);
+}
+
+/* Closes the timerfd of a driver */
+void flexitimer_linux_deinit(flexitimer_linux_t *driver)
+{
+    if((driver != NULL) && (driver->fd >= 0))
+    {
+        (void)close(driver->fd);
+        driver->fd = -1;
+    }
+}
+
+/* Gets the file descriptor of a driver */
+int flexitimer_linux_fd(const flexitimer_linux_t *driver)
+{
+    return (driver != NULL) ? driver->fd : -1;
+}
+
+/* Processes the elapsed ticks and arms the timerfd for the next deadline */
+flexitimer_error_t flexitimer_linux_dispatch(flexitimer_linux_t *driver)
+{
+    if((driver == NULL) || (driver->fd < 0))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    uint64_t expirations;
+    (void)read(driver->fd, &expirations, sizeof(expirations)); // EAGAIN on a spurious wakeup
+    __atomic_store_n(&driver->wakeup, 0u, __ATOMIC_SEQ_CST);
+
+    uint64_t now = (linux_now_ns() - driver->origin_ns) / driver->tick_ns;
+
+    while(driver->ticks < now)
+    {
+        uint64_t elapsed = now - driver->ticks;
+        timer_time_t step = (elapsed > (timer_time_t)~0u) ? (timer_time_t)~0u : (timer_time_t)elapsed;
+        flexitimer_ctx_advance(driver->ctx, step);
+        driver->ticks += step;
+    }
+
+    return flexitimer_linux_rearm(driver);
+}
+
+/* Arms the timerfd for the next deadline */
+flexitimer_error_t flexitimer_linux_rearm(flexitimer_linux_t *driver)
+{
+    if((driver == NULL) || (driver->fd < 0))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    timer_time_t next;
+    uint64_t when = 0;
+
+    if(flexitimer_ctx_next_expiry(driver->ctx, &next) == FLEXITIMER_OK)
+    {
+        when = driver->origin_ns + ((driver->ticks + next) * driver->tick_ns);
+    }
+
+    flexitimer_error_t error = linux_settime(driver, when);
+
+    /* A wakeup that raced with the arming above must not be overwritten */
+    if((error == FLEXITIMER_OK) && (__atomic_load_n(&driver->wakeup, __ATOMIC_SEQ_CST) != 0u))
+    {
+        error = linux_settime(driver, 1u);
+    }
+
+    return error;
+}
+
+/* Makes the descriptor readable at once */
+flexitimer_error_t flexitimer_linux_wakeup(flexitimer_linux_t *driver)
+{
+    if((driver == NULL) || (driver->fd < 0))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    __atomic_store_n(&driver->wakeup, 1u, __ATOMIC_SEQ_CST);
+    return linux_settime(driver, 1u); // an absolute time in the past expires immediately
+}
+
+/* Runs the scheduler on the calling thread */
+flexitimer_error_t flexitimer_linux_run(flexitimer_linux_t *driver)
+{
+    if((driver == NULL) || (driver->fd < 0))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    flexitimer_error_t error = FLEXITIMER_OK;
+    struct pollfd pfd = {driver->fd, POLLIN, 0};
+
+    while((error == FLEXITIMER_OK) && (__atomic_load_n(&driver->running, __ATOMIC_ACQUIRE) != 0u))
+    {
+        if(poll(&pfd, 1, -1) < 0)
+        {
+            error = (errno == EINTR) ? FLEXITIMER_OK : FLEXITIMER_ERROR_SYSTEM;
+        }
+        else
+        {
+            error = flexitimer_linux_dispatch(driver);
+        }
+    }
+
+    __atomic_store_n(&driver->running, 1u, __ATOMIC_RELEASE); // ready to run again
+    return error;
+}
+
+/* Makes flexitimer_linux_run() return */
+void flexitimer_linux_stop(flexitimer_linux_t *driver)
+{
+    if(driver != NULL)
+    {
+        __atomic_store_n(&driver->running, 0u, __ATOMIC_RELEASE);
+        (void)flexitimer_linux_wakeup(driver);
+    }
+}
+
+/* Gets the jitter histogram bucket of a lateness */
+static uint32_t jitter_bucket(uint64_t ns)
+{
+    if(ns < 8u)
+    {
+        return (uint32_t)ns;
+    }
+
+    uint32_t exponent = 63u - (uint32_t)__builtin_clzll(ns);
+    return ((exponent - 2u) * 8u) + (uint32_t)((ns >> (exponent - 3u)) & 7u);
+}
+
+/* Gets the largest lateness of a jitter histogram bucket */
+static uint64_t jitter_bucket_limit(uint32_t bucket)
+{
+    if(bucket < 8u)
+    {
+        return bucket;
+    }
+
+    uint32_t shift = (bucket / 8u) - 1u;
+    return ((((uint64_t)(bucket % 8u) + 9u) << shift) - 1u);
+}
+
+/* Accounts the lateness of one tick */
+static void tick_record(flexitimer_linux_tick_t *tick, uint64_t late_ns)
+{
+    /* Single writer, the relaxed atomics only keep concurrent readers of the report untorn */
+    uint32_t bucket = jitter_bucket(late_ns);
+    __atomic_store_n(&tick->histogram[bucket], tick->histogram[bucket] + 1u, __ATOMIC_RELAXED);
+    __atomic_store_n(&tick->sum_ns, tick->sum_ns + late_ns, __ATOMIC_RELAXED);
+
+    if(late_ns < tick->min_ns)
+    {
+        __atomic_store_n(&tick->min_ns, late_ns, __ATOMIC_RELAXED);
+    }
+
+    if(late_ns > tick->max_ns)
+    {
+        __atomic_store_n(&tick->max_ns, late_ns, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&tick->ticks, tick->ticks + 1u, __ATOMIC_RELEASE);
+}
+
+/* Tick thread body */
+static void *tick_thread(void *arg)
+{
+    flexitimer_linux_tick_t *tick = (flexitimer_linux_tick_t *)arg;
+    uint64_t period = tick->config.tick_ns;
+    uint64_t deadline = linux_now_ns() + period;
+
+    while(__atomic_load_n(&tick->running, __ATOMIC_ACQUIRE) != 0u)
+    {
+        uint64_t wake = deadline - ((tick->config.spin_ns < period) ? tick->config.spin_ns : period);
+        struct timespec ts;
+        ts.tv_sec = (time_t)(wake / NS_PER_SEC);
+        ts.tv_nsec = (long)(wake % NS_PER_SEC);
+
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+        }
+
+        uint64_t now = linux_now_ns();
+
+        while(now < deadline)
+        {
+            now = linux_now_ns();
+        }
+
+        tick_record(tick, now - deadline);
+
+        /* Ticks whose deadline passed during an overrun are caught up in one batch */
+        uint64_t due = ((now - deadline) / period) + 1u;
+
+        if(due == 1u)
+        {
+            flexitimer_ctx_handler(tick->ctx);
+        }
+        else
+        {
+            __atomic_store_n(&tick->missed, tick->missed + due - 1u, __ATOMIC_RELAXED);
+            flexitimer_ctx_advance(tick->ctx, (timer_time_t)due);
+        }
+
+        deadline += due * period;
+    }
+
+    return NULL;
+}
+
+/* Starts a tick thread */
+flexitimer_error_t flexitimer_linux_tick_start(flexitimer_linux_tick_t *tick, flexitimer_ctx_t *ctx, const flexitimer_linux_tick_config_t *config)
+{
+    if((tick == NULL) || (config == NULL) || (config->tick_ns == 0u))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    tick->ctx = (ctx != NULL) ? ctx : flexitimer_default_ctx();
+    tick->config = *config;
+    tick->running = 1u;
+    tick->ticks = 0;
+    tick->missed = 0;
+    tick->sum_ns = 0;
+    tick->min_ns = UINT64_MAX;
+    tick->max_ns = 0;
+
+    for(uint32_t i = 0; i < FLEXITIMER_LINUX_JITTER_BUCKETS; i++)
+    {
+        tick->histogram[i] = 0;
+    }
+
+    pthread_attr_t attr;
+    int result = pthread_attr_init(&attr);
+
+    if((result == 0) && (config->cpu >= 0))
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(config->cpu, &cpus);
+        result = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    if((result == 0) && (config->priority > 0))
+    {
+        struct sched_param param = {0};
+        param.sched_priority = config->priority;
+        result = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        result = (result == 0) ? pthread_attr_setschedpolicy(&attr, SCHED_FIFO) : result;
+        result = (result == 0) ? pthread_attr_setschedparam(&attr, &param) : result;
+    }
+
+    result = (result == 0) ? pthread_create(&tick->thread, &attr, tick_thread, tick) : result;
+    (void)pthread_attr_destroy(&attr);
+
+    if(result != 0)
+    {
+        errno = result;
+        return FLEXITIMER_ERROR_SYSTEM;
+    }
+
+    return FLEXITIMER_OK;
+}
+
+/* Stops a tick thread */
+void flexitimer_linux_tick_stop(flexitimer_linux_tick_t *tick)
+{
+    if(tick != NULL)
+    {
+        __atomic_store_n(&tick->running, 0u, __ATOMIC_RELEASE);
+        (void)pthread_join(tick->thread, NULL);
+    }
+}
+
+/* Gets the tick jitter measured so far */
+flexitimer_error_t flexitimer_linux_tick_jitter(const flexitimer_linux_tick_t *tick, flexitimer_linux_jitter_t *jitter)
+{
+    if((tick == NULL) || (jitter == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    uint64_t ticks = __atomic_load_n(&tick->ticks, __ATOMIC_ACQUIRE);
+    jitter->ticks = ticks;
+    jitter->missed = __atomic_load_n(&tick->missed, __ATOMIC_RELAXED);
+    jitter->min_ns = (ticks > 0u) ? __atomic_load_n(&tick->min_ns, __ATOMIC_RELAXED) : 0u;
+    jitter->max_ns = __atomic_load_n(&tick->max_ns, __ATOMIC_RELAXED);
+    jitter->avg_ns = (ticks > 0u) ? (__atomic_load_n(&tick->sum_ns, __ATOMIC_RELAXED) / ticks) : 0u;
+    jitter->p99_ns = 0;
+
+    /* Walk the histogram up to 99% of the ticks it held when counted */
+    uint64_t counted = 0;
+    uint64_t total = 0;
+
+    for(uint32_t i = 0; i < FLEXITIMER_LINUX_JITTER_BUCKETS; i++)
+    {
+        total += __atomic_load_n(&tick->histogram[i], __ATOMIC_RELAXED);
+    }
+
+    for(uint32_t i = 0; (i < FLEXITIMER_LINUX_JITTER_BUCKETS) && (total > 0u); i++)
+    {
+        counted += __atomic_load_n(&tick->histogram[i], __ATOMIC_RELAXED);
+
+        if((counted * 100u) >= (total * 99u))
+        {
+            uint64_t limit = jitter_bucket_limit(i);
+            jitter->p99_ns = (limit < jitter->max_ns) ? limit : jitter->max_ns;
+            break;
+        }
+    }
+
+    return FLEXITIMER_OK;
+}
+
+#endif // __linux__
@@ -0,0 +1,250 @@
+/**
+    @file flexitimer_pool.c
+    @brief FlexiTimer Scheduler Library - timer handles
+
+    The timers of a context double as a pool: the free ones form a singly linked list through
+    their records, so allocation and release are O(1) without any heap allocation or search.
+    A handle packs the timer index with the generation of its record. The generation is
+    incremented on both allocation and release, it is odd while the timer is allocated, so a
+    handle kept after flexitimer_destroy() no longer matches once the record is released or reused,
+    and the all-zero handle never matches.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+#include <stdio.h> // for NULL
+
+#if FLEXITIMER_HANDLES
+
+#define HANDLE_INDEX_MASK       (((flexitimer_handle_t)1u << FLEXITIMER_HANDLE_INDEX_BITS) - 1u)
+#define HANDLE_GENERATION_MASK  (((flexitimer_handle_t)1u << (FLEXITIMER_HANDLE_BITS - FLEXITIMER_HANDLE_INDEX_BITS)) - 1u)
+#define NODE_NONE               ((flexitimer_node_t)UINT32_MAX)
+
+/* Resolves a handle to the timer id, fails for free timers and stale handles */
+static flexitimer_error_t handle_resolve(const flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_id_t *id)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    flexitimer_handle_t index = handle & HANDLE_INDEX_MASK;
+    flexitimer_handle_t generation = handle >> FLEXITIMER_HANDLE_INDEX_BITS;
+
+    if(index >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    uint32_t current = ctx->timers[index].generation;
+
+    if(((current & 1u) == 0u) || (((flexitimer_handle_t)current & HANDLE_GENERATION_MASK) != generation))
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    *id = (timer_id_t)index;
+    return FLEXITIMER_OK;
+}
+
+/* Puts all timers of a context into the pool */
+void flexitimer_pool_init(flexitimer_ctx_t *ctx)
+{
+    for(uint32_t i = 0; i < ctx->capacity; i++)
+    {
+        ctx->timers[i].generation = 0;
+        ctx->timers[i].next_free = ((i + 1u) < ctx->capacity) ? (i + 1u) : NODE_NONE;
+    }
+
+    ctx->free_head = 0;
+}
+
+/* Allocates a timer from the pool */
+flexitimer_error_t flexitimer_ctx_create(flexitimer_ctx_t *ctx, flexitimer_handle_t *handle)
+{
+    if((ctx == NULL) || (handle == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(ctx->free_head == NODE_NONE)
+    {
+        return FLEXITIMER_ERROR_FULL;
+    }
+
+    flexitimer_node_t index = ctx->free_head;
+    flexitimer_timer_t *timer = &ctx->timers[index];
+    ctx->free_head = timer->next_free;
+    timer->next_free = NODE_NONE;
+    timer->generation++;
+    *handle = (((flexitimer_handle_t)timer->generation & HANDLE_GENERATION_MASK) << FLEXITIMER_HANDLE_INDEX_BITS) | (flexitimer_handle_t)index;
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_HANDLE_CREATE, index, timer->generation);
+    return FLEXITIMER_OK;
+}
+
+/* Cancels a timer and returns it to the pool */
+flexitimer_error_t flexitimer_ctx_destroy(flexitimer_ctx_t *ctx, flexitimer_handle_t handle)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+
+    if(error != FLEXITIMER_OK)
+    {
+        return error;
+    }
+
+    (void)flexitimer_ctx_cancel(ctx, id);
+    flexitimer_trace(ctx, FLEXITIMER_TRACE_HANDLE_DESTROY, id, ctx->timers[id].generation);
+    ctx->timers[id].generation++;
+    ctx->timers[id].next_free = ctx->free_head;
+    ctx->free_head = id;
+    return FLEXITIMER_OK;
+}
+
+/* Gets the timer id of a handle */
+flexitimer_error_t flexitimer_ctx_handle_id(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_id_t *id)
+{
+    if(id == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    return handle_resolve(ctx, handle, id);
+}
+
+/* Starts a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_start(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_start(ctx, id, type, timeout, callback) : error;
+}
+
+/* Delays a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_delay(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_time_t delay)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_delay(ctx, id, delay) : error;
+}
+
+/* Pauses a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_pause(flexitimer_ctx_t *ctx, flexitimer_handle_t handle)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_pause(ctx, id) : error;
+}
+
+/* Resumes a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_resume(flexitimer_ctx_t *ctx, flexitimer_handle_t handle)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_resume(ctx, id) : error;
+}
+
+/* Restarts a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_restart(flexitimer_ctx_t *ctx, flexitimer_handle_t handle)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_restart(ctx, id) : error;
+}
+
+/* Cancels a timer by handle, the timer stays allocated */
+flexitimer_error_t flexitimer_ctx_handle_cancel(flexitimer_ctx_t *ctx, flexitimer_handle_t handle)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_cancel(ctx, id) : error;
+}
+
+/* Gets the state of a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_get_state(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_state_t *state)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_get_state(ctx, id, state) : error;
+}
+
+/* Gets the remaining time of a timer by handle */
+flexitimer_error_t flexitimer_ctx_handle_get_elapsed(flexitimer_ctx_t *ctx, flexitimer_handle_t handle, timer_time_t *time)
+{
+    timer_id_t id;
+    flexitimer_error_t error = handle_resolve(ctx, handle, &id);
+    return (error == FLEXITIMER_OK) ? flexitimer_ctx_get_elapsed(ctx, id, time) : error;
+}
+
+/* Allocates a timer from the pool of the default context */
+flexitimer_error_t flexitimer_create(flexitimer_handle_t *handle)
+{
+    return flexitimer_ctx_create(flexitimer_default_ctx(), handle);
+}
+
+/* Returns a timer to the pool of the default context */
+flexitimer_error_t flexitimer_destroy(flexitimer_handle_t handle)
+{
+    return flexitimer_ctx_destroy(flexitimer_default_ctx(), handle);
+}
+
+/* Gets the timer id of a handle of the default context */
+flexitimer_error_t flexitimer_handle_id(flexitimer_handle_t handle, timer_id_t *id)
+{
+    return flexitimer_ctx_handle_id(flexitimer_default_ctx(), handle, id);
+}
+
+/* Starts a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_start(flexitimer_handle_t handle, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    return flexitimer_ctx_handle_start(flexitimer_default_ctx(), handle, type, timeout, callback);
+}
+
+/* Delays a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_delay(flexitimer_handle_t handle, timer_time_t delay)
+{
+    return flexitimer_ctx_handle_delay(flexitimer_default_ctx(), handle, delay);
+}
+
+/* Pauses a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_pause(flexitimer_handle_t handle)
+{
+    return flexitimer_ctx_handle_pause(flexitimer_default_ctx(), handle);
+}
+
+/* Resumes a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_resume(flexitimer_handle_t handle)
+{
+    return flexitimer_ctx_handle_resume(flexitimer_default_ctx(), handle);
+}
+
+/* Restarts a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_restart(flexitimer_handle_t handle)
+{
+    return flexitimer_ctx_handle_restart(flexitimer_default_ctx(), handle);
+}
+
+/* Cancels a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_cancel(flexitimer_handle_t handle)
+{
+    return flexitimer_ctx_handle_cancel(flexitimer_default_ctx(), handle);
+}
+
+/* Gets the state of a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_get_state(flexitimer_handle_t handle, timer_state_t *state)
+{
+    return flexitimer_ctx_handle_get_state(flexitimer_default_ctx(), handle, state);
+}
+
+/* Gets the remaining time of a timer of the default context by handle */
+flexitimer_error_t flexitimer_handle_get_elapsed(flexitimer_handle_t handle, timer_time_t *time)
+{
+    return flexitimer_ctx_handle_get_elapsed(flexitimer_default_ctx(), handle, time);
+}
+
+#endif // FLEXITIMER_HANDLES
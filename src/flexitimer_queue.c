@@ -0,0 +1,229 @@
+/**
+    @file flexitimer_queue.c
+    @brief FlexiTimer Scheduler Library - cross-thread command queue
+
+    Bounded lock-free multi-producer single-consumer ring of timer commands (D. Vyukov's
+    bounded queue). Every cell carries a sequence number: a producer claims a cell with one
+    compare-and-swap on the tail and publishes it by advancing the cell sequence, the handler
+    thread consumes the published cells in order without any atomic read-modify-write.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+#include <stdio.h> // for NULL
+
+#if FLEXITIMER_QUEUE_SIZE > 0
+
+#if !defined(__GNUC__)
+#error "The command queue requires the GCC/Clang __atomic builtins"
+#endif
+
+#define QUEUE_MASK ((uint32_t)FLEXITIMER_QUEUE_SIZE - 1u)
+
+/**
+    @brief Command operations.
+*/
+typedef enum
+{
+    COMMAND_START,
+    COMMAND_DELAY,
+    COMMAND_PAUSE,
+    COMMAND_RESUME,
+    COMMAND_RESTART,
+    COMMAND_CANCEL
+} command_op_t;
+
+/* Queues a command, lock-free for any number of producers */
+static flexitimer_error_t queue_post(flexitimer_ctx_t *ctx, command_op_t op, timer_id_t id, timer_type_t type, timer_time_t value, timer_callback_t callback)
+{
+    if(ctx == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    uint32_t position = __atomic_load_n(&ctx->queue_tail, __ATOMIC_RELAXED);
+    flexitimer_command_t *cell;
+
+    for(;;)
+    {
+        cell = &ctx->queue[position & QUEUE_MASK];
+        uint32_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(sequence - position);
+
+        if(diff == 0)
+        {
+            if(__atomic_compare_exchange_n(&ctx->queue_tail, &position, position + 1u, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            return FLEXITIMER_ERROR_FULL;
+        }
+        else
+        {
+            position = __atomic_load_n(&ctx->queue_tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->op = (uint8_t)op;
+    cell->id = id;
+    cell->type = type;
+    cell->value = value;
+    cell->callback = callback;
+    __atomic_store_n(&cell->sequence, position + 1u, __ATOMIC_RELEASE);
+    return FLEXITIMER_OK;
+}
+
+/* Resets the command queue */
+void flexitimer_queue_init(flexitimer_ctx_t *ctx)
+{
+    for(uint32_t i = 0; i < FLEXITIMER_QUEUE_SIZE; i++)
+    {
+        ctx->queue[i].sequence = i;
+    }
+
+    ctx->queue_head = 0;
+    __atomic_store_n(&ctx->queue_tail, 0u, __ATOMIC_RELEASE);
+}
+
+/* Applies the queued commands, at most one queue length per call */
+uint32_t flexitimer_queue_drain(flexitimer_ctx_t *ctx)
+{
+    uint32_t i;
+
+    for(i = 0; i < FLEXITIMER_QUEUE_SIZE; i++)
+    {
+        uint32_t position = ctx->queue_head;
+        flexitimer_command_t *cell = &ctx->queue[position & QUEUE_MASK];
+
+        if(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != (position + 1u))
+        {
+            break; // empty, or the producer has not published it yet
+        }
+
+        flexitimer_command_t command = *cell;
+        __atomic_store_n(&cell->sequence, position + FLEXITIMER_QUEUE_SIZE, __ATOMIC_RELEASE);
+        ctx->queue_head = position + 1u;
+
+        switch((command_op_t)command.op)
+        {
+            case COMMAND_START:
+                (void)flexitimer_ctx_start(ctx, command.id, command.type, command.value, command.callback);
+                break;
+
+            case COMMAND_DELAY:
+                (void)flexitimer_ctx_delay(ctx, command.id, command.value);
+                break;
+
+            case COMMAND_PAUSE:
+                (void)flexitimer_ctx_pause(ctx, command.id);
+                break;
+
+            case COMMAND_RESUME:
+                (void)flexitimer_ctx_resume(ctx, command.id);
+                break;
+
+            case COMMAND_RESTART:
+                (void)flexitimer_ctx_restart(ctx, command.id);
+                break;
+
+            case COMMAND_CANCEL:
+            default:
+                (void)flexitimer_ctx_cancel(ctx, command.id);
+                break;
+        }
+    }
+
+    return i;
+}
+
+/* Queues a timer start */
+flexitimer_error_t flexitimer_ctx_post_start(flexitimer_ctx_t *ctx, timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    if(type == TIMER_TYPE_PERIODIC && timeout == 0)
+    {
+        return FLEXITIMER_ERROR_ZERO_TIMEOUT;
+    }
+
+    return queue_post(ctx, COMMAND_START, id, type, timeout, callback);
+}
+
+/* Queues a timer delay */
+flexitimer_error_t flexitimer_ctx_post_delay(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t delay)
+{
+    return queue_post(ctx, COMMAND_DELAY, id, TIMER_TYPE_SINGLESHOT, delay, NULL);
+}
+
+/* Queues a timer pause */
+flexitimer_error_t flexitimer_ctx_post_pause(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    return queue_post(ctx, COMMAND_PAUSE, id, TIMER_TYPE_SINGLESHOT, 0, NULL);
+}
+
+/* Queues a timer resume */
+flexitimer_error_t flexitimer_ctx_post_resume(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    return queue_post(ctx, COMMAND_RESUME, id, TIMER_TYPE_SINGLESHOT, 0, NULL);
+}
+
+/* Queues a timer restart */
+flexitimer_error_t flexitimer_ctx_post_restart(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    return queue_post(ctx, COMMAND_RESTART, id, TIMER_TYPE_SINGLESHOT, 0, NULL);
+}
+
+/* Queues a timer cancel */
+flexitimer_error_t flexitimer_ctx_post_cancel(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    return queue_post(ctx, COMMAND_CANCEL, id, TIMER_TYPE_SINGLESHOT, 0, NULL);
+}
+
+/* Queues a timer start on the default context */
+flexitimer_error_t flexitimer_post_start(timer_id_t id, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    return flexitimer_ctx_post_start(flexitimer_default_ctx(), id, type, timeout, callback);
+}
+
+/* Queues a timer delay on the default context */
+flexitimer_error_t flexitimer_post_delay(timer_id_t id, timer_time_t delay)
+{
+    return flexitimer_ctx_post_delay(flexitimer_default_ctx(), id, delay);
+}
+
+/* Queues a timer pause on the default context */
+flexitimer_error_t flexitimer_post_pause(timer_id_t id)
+{
+    return flexitimer_ctx_post_pause(flexitimer_default_ctx(), id);
+}
+
+/* Queues a timer resume on the default context */
+flexitimer_error_t flexitimer_post_resume(timer_id_t id)
+{
+    return flexitimer_ctx_post_resume(flexitimer_default_ctx(), id);
+}
+
+/* Queues a timer restart on the default context */
+flexitimer_error_t flexitimer_post_restart(timer_id_t id)
+{
+    return flexitimer_ctx_post_restart(flexitimer_default_ctx(), id);
+}
+
+/* Queues a timer cancel on the default context */
+flexitimer_error_t flexitimer_post_cancel(timer_id_t id)
+{
+    return flexitimer_ctx_post_cancel(flexitimer_default_ctx(), id);
+}
+
+#endif // FLEXITIMER_QUEUE_SIZE
@@ -0,0 +1,202 @@
+/**
+    @file flexitimer_scan.c
+    @brief FlexiTimer Scheduler Library - linear scan engine
+
+    Every tick counts down the remaining time of the active timers. A bitmap of the context marks
+    the timers that are armed, so a tick walks its set bits with count-trailing-zeros and never
+    touches the passive slots. Contexts larger than the bitmap use one bit per block of timers,
+    a block bit is cleared once a tick finds no armed timer in the block.
+    Smallest footprint, best suited to a few tens of timers.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+
+#if (FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_SCAN) && !FLEXITIMER_SCAN_SOA
+
+#define BITMAP_BITS     (FLEXITIMER_BITMAP_WORDS * 64u)
+#define BIT(index)      ((uint64_t)1u << ((index) & 63u))
+#define WORD(index)     ((index) >> 6u)
+
+/* Gets the bit set of a bitmap word above the given bit */
+#define ABOVE(bits, bit) ((bits) & ((~(uint64_t)1u) << (bit)))
+
+/* Counts down the armed timers of one block, returns whether any of them is still armed */
+static uint32_t scan_tick_block(flexitimer_ctx_t *ctx, uint32_t block)
+{
+    flexitimer_timer_t *timers = ctx->timers;
+    uint32_t first = block << ctx->block_shift;
+    uint32_t last = first + ((uint32_t)1u << ctx->block_shift);
+    uint32_t armed = 0;
+
+    if(last > ctx->capacity)
+    {
+        last = ctx->capacity;
+    }
+
+    for(uint32_t i = first; i < last; i++)
+    {
+        if(timers[i].state == TIMER_STATE_ACTIVE)
+        {
+            if(timers[i].remaining > 0)
+            {
+                timers[i].remaining--;
+            }
+
+            if(timers[i].remaining == 0)
+            {
+                flexitimer_expire(ctx, (timer_id_t)i);
+            }
+
+            armed |= (timers[i].state == TIMER_STATE_ACTIVE) ? 1u : 0u;
+        }
+    }
+
+    return armed;
+}
+
+/* Resets the engine */
+void flexitimer_engine_init(flexitimer_ctx_t *ctx)
+{
+    ctx->block_shift = 0;
+
+    while(((ctx->capacity - 1u) >> ctx->block_shift) >= BITMAP_BITS)
+    {
+        ctx->block_shift++;
+    }
+
+    for(uint32_t w = 0; w < FLEXITIMER_BITMAP_WORDS; w++)
+    {
+        ctx->active[w] = 0;
+    }
+
+    ctx->now = 0;
+}
+
+/* Arms a timer */
+void flexitimer_engine_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    uint32_t block = (uint32_t)id >> ctx->block_shift;
+    ctx->timers[id].remaining = ticks;
+    ctx->active[WORD(block)] |= BIT(block);
+}
+
+/* Disarms a timer, a shared block bit is left to the next tick */
+void flexitimer_engine_disarm(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    if(ctx->block_shift == 0u)
+    {
+        ctx->active[WORD(id)] &= ~BIT(id);
+    }
+}
+
+/* Gets the remaining ticks of a timer */
+timer_time_t flexitimer_engine_remaining(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    return ctx->timers[id].remaining;
+}
+
+/* Advances one tick */
+void flexitimer_engine_tick(flexitimer_ctx_t *ctx)
+{
+    uint32_t words = WORD((ctx->capacity - 1u) >> ctx->block_shift) + 1u;
+    ctx->now++;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        uint64_t bits = ctx->active[w];
+
+        /* The word is read again after every block, callbacks may arm timers of later blocks */
+        while(bits != 0u)
+        {
+            uint32_t bit = flexitimer_ctz64(bits);
+            ctx->active[w] &= ~BIT(bit);
+
+            if(scan_tick_block(ctx, (w * 64u) + bit) != 0u)
+            {
+                ctx->active[w] |= BIT(bit);
+            }
+
+            bits = ABOVE(ctx->active[w], bit);
+        }
+    }
+}
+
+/* Gets the ticks until the next expiry */
+timer_time_t flexitimer_engine_next(flexitimer_ctx_t *ctx)
+{
+    uint32_t words = WORD((ctx->capacity - 1u) >> ctx->block_shift) + 1u;
+    timer_time_t next = 0;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        for(uint64_t bits = ctx->active[w]; bits != 0u; bits &= bits - 1u)
+        {
+            uint32_t first = ((w * 64u) + flexitimer_ctz64(bits)) << ctx->block_shift;
+            uint32_t last = first + ((uint32_t)1u << ctx->block_shift);
+
+            for(uint32_t i = first; (i < last) && (i < ctx->capacity); i++)
+            {
+                if(ctx->timers[i].state == TIMER_STATE_ACTIVE)
+                {
+                    timer_time_t ticks = (ctx->timers[i].remaining > 0u) ? ctx->timers[i].remaining : 1u;
+
+                    if((next == 0u) || (ticks < next))
+                    {
+                        next = ticks;
+                    }
+                }
+            }
+        }
+    }
+
+    return next;
+}
+
+/* Skips ticks without expiries */
+void flexitimer_engine_skip(flexitimer_ctx_t *ctx, timer_time_t ticks)
+{
+    uint32_t words = WORD((ctx->capacity - 1u) >> ctx->block_shift) + 1u;
+
+    if(ticks > 0u)
+    {
+        ctx->now += ticks;
+
+        for(uint32_t w = 0; w < words; w++)
+        {
+            for(uint64_t bits = ctx->active[w]; bits != 0u; bits &= bits - 1u)
+            {
+                uint32_t first = ((w * 64u) + flexitimer_ctz64(bits)) << ctx->block_shift;
+                uint32_t last = first + ((uint32_t)1u << ctx->block_shift);
+
+                for(uint32_t i = first; (i < last) && (i < ctx->capacity); i++)
+                {
+                    if(ctx->timers[i].state == TIMER_STATE_ACTIVE)
+                    {
+                        ctx->timers[i].remaining -= ticks;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Starts a batch, the arms and disarms need no deferred work */
+void flexitimer_engine_batch_begin(flexitimer_ctx_t *ctx, uint32_t count)
+{
+    (void)ctx;
+    (void)count;
+}
+
+/* Ends a batch */
+void flexitimer_engine_batch_end(flexitimer_ctx_t *ctx)
+{
+    (void)ctx;
+}
+
+#endif // FLEXITIMER_ENGINE_SCAN
@@ -0,0 +1,463 @@
+/**
+    @file flexitimer_shards.c
+    @brief FlexiTimer Scheduler Library - sharded per-core schedulers (Linux)
+
+    Every shard thread runs its context like the tick thread of the Linux driver, on deadlines
+    derived from the common origin, and applies the commands posted to its queue while idle.
+    The contexts hand every expiration to their shard as a job. A thread runs the jobs of its
+    own shard first and then steals from the others, taking the oldest job under the lock of
+    the victim. A job whose timer is running on another thread is moved to the back of the
+    queue, which keeps a callback from overlapping with itself; the running callback of each
+    thread is published under the lock of the shard that owns the timer.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // pthread_setaffinity_np, sched_getcpu
+#endif
+
+#include "flexitimer_shards.h"
+#include "flexitimer_internal.h"
+
+#if FLEXITIMER_QUEUE_SIZE > 0
+
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+
+#define NS_PER_SEC      (1000000000u)
+#define JOB_MASK        (FLEXITIMER_SHARD_JOBS - 1u)
+#define RUNNING_NONE    (UINT64_MAX)
+#define RUNNING_KEY(shard, id) (((uint64_t)(shard) << 32u) | (uint64_t)(id))
+
+static __thread uint32_t callback_shard; // shard of the callback running on this thread
+
+/* Reads CLOCK_MONOTONIC in nanoseconds */
+static uint64_t shards_now_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * NS_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
+
+/* Sleeps until an absolute CLOCK_MONOTONIC time */
+static void shards_sleep_until(uint64_t when_ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(when_ns / NS_PER_SEC);
+    ts.tv_nsec = (long)(when_ns % NS_PER_SEC);
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+}
+
+/* Checks whether a timer's callback runs on any thread, called under the lock of its shard */
+static int shards_busy(const flexitimer_shards_t *sharded, uint64_t key)
+{
+    for(uint32_t i = 0; i < sharded->count; i++)
+    {
+        if(__atomic_load_n(&sharded->shards[i].running, __ATOMIC_RELAXED) == key)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Runs the oldest runnable job of a victim shard on the thread of self, returns 0 if there is none */
+static int shards_work(flexitimer_shards_t *sharded, flexitimer_shard_t *self, uint32_t victim)
+{
+    flexitimer_shard_t *shard = &sharded->shards[victim];
+    flexitimer_shard_job_t job;
+    int found = 0;
+
+    (void)pthread_mutex_lock(&shard->lock);
+
+    for(uint32_t n = shard->job_tail - shard->job_head; (n > 0u) && (found == 0); n--)
+    {
+        job = shard->jobs[shard->job_head & JOB_MASK];
+        shard->job_head++;
+
+        if(shards_busy(sharded, RUNNING_KEY(victim, job.id)) != 0)
+        {
+            shard->jobs[shard->job_tail & JOB_MASK] = job; // retried after the running one
+            shard->job_tail++;
+        }
+        else
+        {
+            __atomic_store_n(&self->running, RUNNING_KEY(victim, job.id), __ATOMIC_RELAXED);
+            found = 1;
+        }
+    }
+
+    (void)pthread_mutex_unlock(&shard->lock);
+
+    if(found == 0)
+    {
+        return 0;
+    }
+
+    callback_shard = victim;
+    job.callback(job.id);
+
+    (void)pthread_mutex_lock(&shard->lock);
+    __atomic_store_n(&self->running, RUNNING_NONE, __ATOMIC_RELAXED);
+    (void)pthread_mutex_unlock(&shard->lock);
+
+    if(self != shard)
+    {
+        __atomic_store_n(&self->stolen, self->stolen + 1u, __ATOMIC_RELAXED);
+    }
+
+    if(sharded->config.order == FLEXITIMER_SHARDS_LOCKSTEP)
+    {
+        (void)__atomic_sub_fetch(&sharded->pending, 1u, __ATOMIC_RELEASE);
+    }
+
+    return 1;
+}
+
+/* Gets the number of queued jobs of a shard */
+static uint32_t shards_left(flexitimer_shard_t *shard)
+{
+    (void)pthread_mutex_lock(&shard->lock);
+    uint32_t left = shard->job_tail - shard->job_head;
+    (void)pthread_mutex_unlock(&shard->lock);
+    return left;
+}
+
+/* Runs one job of the own shard or, failing that, of another one */
+static int shards_work_any(flexitimer_shards_t *sharded, uint32_t index)
+{
+    if(shards_work(sharded, &sharded->shards[index], index) != 0)
+    {
+        return 1;
+    }
+
+    for(uint32_t i = 1; i < sharded->count; i++)
+    {
+        if(shards_work(sharded, &sharded->shards[index], (index + i) % sharded->count) != 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Queues an expiration as a job of its shard, called by the shard thread during the tick */
+static void shards_submit(void *arg, timer_id_t id, timer_callback_t callback)
+{
+    flexitimer_shard_t *shard = (flexitimer_shard_t *)arg;
+    flexitimer_shards_t *sharded = (flexitimer_shards_t *)shard->owner;
+    uint32_t index = (uint32_t)(shard - sharded->shards);
+
+    (void)pthread_mutex_lock(&shard->lock);
+
+    while((shard->job_tail - shard->job_head) == FLEXITIMER_SHARD_JOBS)
+    {
+        /* Full, make room by running jobs on this thread */
+        (void)pthread_mutex_unlock(&shard->lock);
+
+        if(shards_work(sharded, shard, index) == 0)
+        {
+            (void)sched_yield();
+        }
+
+        (void)pthread_mutex_lock(&shard->lock);
+    }
+
+    shard->jobs[shard->job_tail & JOB_MASK].id = id;
+    shard->jobs[shard->job_tail & JOB_MASK].callback = callback;
+    shard->job_tail++;
+
+    if(sharded->config.order == FLEXITIMER_SHARDS_LOCKSTEP)
+    {
+        (void)__atomic_add_fetch(&sharded->pending, 1u, __ATOMIC_RELAXED);
+    }
+
+    (void)pthread_mutex_unlock(&shard->lock);
+}
+
+/* Applies commands and runs jobs until the deadline, sleeping at most idle_ns while there are none */
+static void shards_idle(flexitimer_shards_t *sharded, uint32_t index, uint64_t deadline)
+{
+    flexitimer_ctx_t *ctx = &sharded->shards[index].ctx;
+    uint64_t now = shards_now_ns();
+
+    while((now < deadline) && (__atomic_load_n(&sharded->running, __ATOMIC_ACQUIRE) != 0u))
+    {
+        if((flexitimer_queue_drain(ctx) == 0u) && (shards_work_any(sharded, index) == 0))
+        {
+            uint64_t wake = now + sharded->config.idle_ns;
+            shards_sleep_until((wake < deadline) ? wake : deadline);
+        }
+
+        now = shards_now_ns();
+    }
+}
+
+/* Shard thread body */
+static void *shards_thread(void *arg)
+{
+    flexitimer_shard_t *shard = (flexitimer_shard_t *)arg;
+    flexitimer_shards_t *sharded = (flexitimer_shards_t *)shard->owner;
+    uint32_t index = (uint32_t)(shard - sharded->shards);
+    uint64_t period = sharded->config.tick_ns;
+    uint64_t deadline = sharded->origin_ns + period;
+    uint8_t started;
+
+    while((started = __atomic_load_n(&sharded->started, __ATOMIC_ACQUIRE)) == 0u)
+    {
+        (void)sched_yield();
+    }
+
+    if(started != 1u)
+    {
+        return NULL;
+    }
+
+    if(sharded->config.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET((uint32_t)sharded->config.cpu + index, &cpus);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    if(sharded->config.order == FLEXITIMER_SHARDS_LOCKSTEP)
+    {
+        /* One tick per round, every shard processes the same ticks */
+        for(;;)
+        {
+            shards_idle(sharded, index, deadline);
+            flexitimer_ctx_handler(&shard->ctx);
+            deadline += period;
+
+            while(__atomic_load_n(&sharded->pending, __ATOMIC_ACQUIRE) != 0u)
+            {
+                if(shards_work_any(sharded, index) == 0)
+                {
+                    (void)sched_yield();
+                }
+            }
+
+            if(pthread_barrier_wait(&sharded->barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+            {
+                sharded->proceed = __atomic_load_n(&sharded->running, __ATOMIC_ACQUIRE);
+            }
+
+            (void)pthread_barrier_wait(&sharded->barrier);
+
+            if(sharded->proceed == 0u)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        while(__atomic_load_n(&sharded->running, __ATOMIC_ACQUIRE) != 0u)
+        {
+            shards_idle(sharded, index, deadline);
+            uint64_t now = shards_now_ns();
+
+            if(now >= deadline)
+            {
+                /* Ticks whose deadline passed while busy are caught up in one batch */
+                uint64_t due = ((now - deadline) / period) + 1u;
+                flexitimer_ctx_advance(&shard->ctx, (timer_time_t)due);
+                deadline += due * period;
+            }
+        }
+
+        /* Run what is left of the own queue */
+        while(shards_left(shard) != 0u)
+        {
+            if(shards_work(sharded, shard, index) == 0)
+            {
+                (void)sched_yield();
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* Initializes the shards and starts their threads */
+flexitimer_error_t flexitimer_shards_init(flexitimer_shards_t *sharded, flexitimer_shard_t *shards, uint32_t count,
+                                          flexitimer_timer_t *storage, uint32_t timers, const flexitimer_shards_config_t *config)
+{
+    if((sharded == NULL) || (shards == NULL) || (storage == NULL) || (config == NULL) ||
+       (count == 0u) || (count > FLEXITIMER_SHARDS_MAX) || (config->tick_ns == 0u) || (config->idle_ns == 0u))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        flexitimer_error_t error = flexitimer_ctx_init(&shards[i].ctx, &storage[(size_t)i * timers], timers);
+
+        if(error != FLEXITIMER_OK)
+        {
+            return error;
+        }
+    }
+
+    sharded->shards = shards;
+    sharded->count = 0;
+    sharded->config = *config;
+    sharded->started = 0u;
+    sharded->running = 1u;
+    sharded->proceed = 1u;
+    sharded->pending = 0;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        flexitimer_shard_t *shard = &shards[i];
+        flexitimer_dispatcher_t dispatcher = {shards_submit, NULL, shard};
+        flexitimer_ctx_set_dispatcher(&shard->ctx, &dispatcher);
+
+        for(uint32_t id = 0; id < timers; id++)
+        {
+            (void)flexitimer_ctx_set_dispatch(&shard->ctx, (timer_id_t)id, FLEXITIMER_DISPATCH_DEFERRED);
+        }
+
+        (void)pthread_mutex_init(&shard->lock, NULL);
+        shard->job_head = 0;
+        shard->job_tail = 0;
+        shard->running = RUNNING_NONE;
+        shard->stolen = 0;
+        shard->owner = sharded;
+    }
+
+    (void)pthread_barrier_init(&sharded->barrier, NULL, count);
+    sharded->origin_ns = shards_now_ns();
+    int result = 0;
+
+    for(uint32_t i = 0; (i < count) && (result == 0); i++)
+    {
+        result = pthread_create(&shards[i].thread, NULL, shards_thread, &shards[i]);
+        sharded->count = (result == 0) ? (i + 1u) : i;
+    }
+
+    /* The threads wait for the outcome, a LOCKSTEP round can not pass without all of them */
+    __atomic_store_n(&sharded->started, (result == 0) ? 1u : 2u, __ATOMIC_RELEASE);
+
+    if(result != 0)
+    {
+        flexitimer_shards_deinit(sharded);
+        errno = result;
+        return FLEXITIMER_ERROR_SYSTEM;
+    }
+
+    return FLEXITIMER_OK;
+}
+
+/* Stops the shard threads */
+void flexitimer_shards_deinit(flexitimer_shards_t *sharded)
+{
+    if(sharded == NULL)
+    {
+        return;
+    }
+
+    __atomic_store_n(&sharded->running, 0u, __ATOMIC_RELEASE);
+
+    for(uint32_t i = 0; i < sharded->count; i++)
+    {
+        (void)pthread_join(sharded->shards[i].thread, NULL);
+    }
+
+    for(uint32_t i = 0; i < sharded->count; i++)
+    {
+        (void)pthread_mutex_destroy(&sharded->shards[i].lock);
+    }
+
+    (void)pthread_barrier_destroy(&sharded->barrier);
+    sharded->count = 0;
+}
+
+/* Gets the shard of the calling thread's CPU */
+uint32_t flexitimer_shards_local(const flexitimer_shards_t *sharded)
+{
+    int cpu = sched_getcpu();
+    return ((sharded == NULL) || (sharded->count == 0u) || (cpu < 0)) ? 0u : ((uint32_t)cpu % sharded->count);
+}
+
+/* Gets the key of a timer of a shard */
+uint32_t flexitimer_shards_key(const flexitimer_shards_t *sharded, uint32_t shard, timer_id_t id)
+{
+    return ((uint32_t)id * sharded->count) + shard;
+}
+
+/* Gets the key of the timer whose callback is running */
+uint32_t flexitimer_shards_callback_key(const flexitimer_shards_t *sharded, timer_id_t id)
+{
+    return flexitimer_shards_key(sharded, callback_shard, id);
+}
+
+/* Resolves a key to its shard context and timer id */
+static flexitimer_ctx_t *shards_resolve(flexitimer_shards_t *sharded, uint32_t key, timer_id_t *id)
+{
+    if((sharded == NULL) || (sharded->count == 0u))
+    {
+        return NULL;
+    }
+
+    flexitimer_ctx_t *ctx = &sharded->shards[key % sharded->count].ctx;
+    uint32_t index = key / sharded->count;
+    *id = (timer_id_t)index;
+    return (index < ctx->capacity) ? ctx : NULL;
+}
+
+/* Queues a timer start on the owning shard */
+flexitimer_error_t flexitimer_shards_start(flexitimer_shards_t *sharded, uint32_t key, timer_type_t type, timer_time_t timeout, timer_callback_t callback)
+{
+    timer_id_t id = 0;
+    flexitimer_ctx_t *ctx = shards_resolve(sharded, key, &id);
+    return (ctx != NULL) ? flexitimer_ctx_post_start(ctx, id, type, timeout, callback) : FLEXITIMER_ERROR_INVALID_ID;
+}
+
+/* Queues a timer delay on the owning shard */
+flexitimer_error_t flexitimer_shards_delay(flexitimer_shards_t *sharded, uint32_t key, timer_time_t delay)
+{
+    timer_id_t id = 0;
+    flexitimer_ctx_t *ctx = shards_resolve(sharded, key, &id);
+    return (ctx != NULL) ? flexitimer_ctx_post_delay(ctx, id, delay) : FLEXITIMER_ERROR_INVALID_ID;
+}
+
+/* Queues a timer restart on the owning shard */
+flexitimer_error_t flexitimer_shards_restart(flexitimer_shards_t *sharded, uint32_t key)
+{
+    timer_id_t id = 0;
+    flexitimer_ctx_t *ctx = shards_resolve(sharded, key, &id);
+    return (ctx != NULL) ? flexitimer_ctx_post_restart(ctx, id) : FLEXITIMER_ERROR_INVALID_ID;
+}
+
+/* Queues a timer cancel on the owning shard */
+flexitimer_error_t flexitimer_shards_cancel(flexitimer_shards_t *sharded, uint32_t key)
+{
+    timer_id_t id = 0;
+    flexitimer_ctx_t *ctx = shards_resolve(sharded, key, &id);
+    return (ctx != NULL) ? flexitimer_ctx_post_cancel(ctx, id) : FLEXITIMER_ERROR_INVALID_ID;
+}
+
+/* Gets the number of callbacks a shard thread ran for other shards */
+uint64_t flexitimer_shards_stolen(const flexitimer_shards_t *sharded, uint32_t shard)
+{
+    return ((sharded != NULL) && (shard < sharded->count)) ? __atomic_load_n(&sharded->shards[shard].stolen, __ATOMIC_RELAXED) : 0u;
+}
+
+#endif // FLEXITIMER_QUEUE_SIZE
+
+#endif // __linux__
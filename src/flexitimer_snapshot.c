@@ -0,0 +1,118 @@
+/**
+    @file flexitimer_snapshot.c
+    @brief FlexiTimer Scheduler Library - lock-free snapshot reads
+
+    Sequence lock over the timers of a context. The handler thread makes the sequence odd
+    before it updates timers and even again afterwards, two stores per update and no wait for
+    readers. A reader copies the timers between two reads of the sequence and repeats the copy
+    if an update was in progress or happened meanwhile.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+#include <stdio.h> // for NULL
+
+#if FLEXITIMER_SNAPSHOT
+
+/* Waits for the end of an update, returns the sequence the copy is checked against */
+static uint32_t snapshot_begin(const flexitimer_ctx_t *ctx)
+{
+    uint32_t sequence = __atomic_load_n(&ctx->sequence, __ATOMIC_ACQUIRE);
+
+    while((sequence & 1u) != 0u)
+    {
+        sequence = __atomic_load_n(&ctx->sequence, __ATOMIC_ACQUIRE);
+    }
+
+    return sequence;
+}
+
+/* Checks that no update started since snapshot_begin() */
+static uint32_t snapshot_valid(const flexitimer_ctx_t *ctx, uint32_t sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE); // the copy is read before the sequence
+    return (__atomic_load_n(&ctx->sequence, __ATOMIC_RELAXED) == sequence) ? 1u : 0u;
+}
+
+/* Copies a timer, the result is only valid if the sequence did not change */
+static void snapshot_copy(const flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_snapshot_t *snapshot)
+{
+    const flexitimer_timer_t *timer = &ctx->timers[id];
+    snapshot->state = flexitimer_timer_state(ctx, id);
+    snapshot->type = (timer_type_t)timer->type;
+    snapshot->timeout = timer->timeout;
+    snapshot->remaining = flexitimer_timer_remaining(ctx, id);
+}
+
+/* Reads a timer of a context from any thread */
+flexitimer_error_t flexitimer_ctx_snapshot(const flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_snapshot_t *snapshot)
+{
+    if((ctx == NULL) || (snapshot == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    uint32_t sequence;
+
+    do
+    {
+        sequence = snapshot_begin(ctx);
+        snapshot_copy(ctx, id, snapshot);
+    }
+    while(snapshot_valid(ctx, sequence) == 0u);
+
+    return FLEXITIMER_OK;
+}
+
+/* Reads the first timers of a context at once from any thread */
+flexitimer_error_t flexitimer_ctx_snapshot_all(const flexitimer_ctx_t *ctx, flexitimer_snapshot_t *snapshots, uint32_t count)
+{
+    if((ctx == NULL) || (snapshots == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(count > ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    uint32_t sequence;
+
+    do
+    {
+        sequence = snapshot_begin(ctx);
+
+        for(uint32_t i = 0; i < count; i++)
+        {
+            snapshot_copy(ctx, (timer_id_t)i, &snapshots[i]);
+        }
+    }
+    while(snapshot_valid(ctx, sequence) == 0u);
+
+    return FLEXITIMER_OK;
+}
+
+/* Reads a timer of the default context from any thread */
+flexitimer_error_t flexitimer_snapshot(timer_id_t id, flexitimer_snapshot_t *snapshot)
+{
+    return flexitimer_ctx_snapshot(flexitimer_default_ctx(), id, snapshot);
+}
+
+/* Reads the first timers of the default context at once from any thread */
+flexitimer_error_t flexitimer_snapshot_all(flexitimer_snapshot_t *snapshots, uint32_t count)
+{
+    return flexitimer_ctx_snapshot_all(flexitimer_default_ctx(), snapshots, count);
+}
+
+#endif // FLEXITIMER_SNAPSHOT
@@ -0,0 +1,227 @@
+/**
+    @file flexitimer_soa.c
+    @brief FlexiTimer Scheduler Library - structure-of-arrays scan engine
+
+    Variant of the linear scan engine for many timers of similar periods. The remaining ticks
+    live in a dense array of the context instead of the timer records, next to a bitmask of the
+    armed timers. A tick first runs a vector kernel over every 64-timer word that has armed
+    timers, decrementing the armed lanes and collecting the expired ones into a bitmask, then
+    expires those in ascending id order. Timers armed from a callback are counted from the next
+    tick, as with the WHEEL and HEAP engines.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+
+#if (FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_SCAN) && FLEXITIMER_SCAN_SOA
+
+/* Kernel selection: 2 AVX2, 1 SSE2, 0 scalar, from the target flags unless forced */
+#ifndef FLEXITIMER_SIMD
+#if defined(__AVX2__)
+#define FLEXITIMER_SIMD (2)
+#elif defined(__SSE2__)
+#define FLEXITIMER_SIMD (1)
+#else
+#define FLEXITIMER_SIMD (0)
+#endif
+#endif
+
+#if FLEXITIMER_SIMD > 0
+#include <immintrin.h>
+#endif
+
+#define BIT(index)  ((uint64_t)1u << ((index) & 63u))
+#define WORD(index) ((index) >> 6u)
+
+/* Decrements the armed lanes of one word, the kernels treat timer_time_t as 32-bit lanes */
+static uint64_t soa_tick_word(timer_time_t *lanes, uint64_t active)
+{
+    uint64_t expired = 0;
+#if FLEXITIMER_SIMD == 2
+    const __m256i select = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for(uint32_t k = 0; k < 64u; k += 8u)
+    {
+        uint32_t bits = (uint32_t)(active >> k) & 0xFFu;
+
+        if(bits != 0u)
+        {
+            __m256i *block = (__m256i *)&lanes[k];
+            __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)bits), select), select);
+            __m256i value = _mm256_loadu_si256(block);
+            __m256i live = _mm256_andnot_si256(_mm256_cmpeq_epi32(value, zero), mask);
+            value = _mm256_add_epi32(value, live); // live lanes are all ones, i.e. -1
+            _mm256_storeu_si256(block, value);
+            __m256i due = _mm256_and_si256(_mm256_cmpeq_epi32(value, zero), mask);
+            expired |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(due)) << k;
+        }
+    }
+#elif FLEXITIMER_SIMD == 1
+    const __m128i select = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i zero = _mm_setzero_si128();
+
+    for(uint32_t k = 0; k < 64u; k += 4u)
+    {
+        uint32_t bits = (uint32_t)(active >> k) & 0xFu;
+
+        if(bits != 0u)
+        {
+            __m128i *block = (__m128i *)&lanes[k];
+            __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int)bits), select), select);
+            __m128i value = _mm_loadu_si128(block);
+            __m128i live = _mm_andnot_si128(_mm_cmpeq_epi32(value, zero), mask);
+            value = _mm_add_epi32(value, live); // live lanes are all ones, i.e. -1
+            _mm_storeu_si128(block, value);
+            __m128i due = _mm_and_si128(_mm_cmpeq_epi32(value, zero), mask);
+            expired |= (uint64_t)(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(due)) << k;
+        }
+    }
+#else
+    while(active != 0u)
+    {
+        uint32_t lane = flexitimer_ctz64(active);
+        active &= active - 1u;
+
+        if(lanes[lane] > 0u)
+        {
+            lanes[lane]--;
+        }
+
+        if(lanes[lane] == 0u)
+        {
+            expired |= BIT(lane);
+        }
+    }
+#endif
+    return expired;
+}
+
+/* Resets the engine */
+void flexitimer_engine_init(flexitimer_ctx_t *ctx)
+{
+    for(uint32_t w = 0; w < FLEXITIMER_BITMAP_WORDS; w++)
+    {
+        ctx->active[w] = 0;
+        ctx->pending[w] = 0;
+    }
+
+    ctx->now = 0;
+}
+
+/* Arms a timer */
+void flexitimer_engine_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    ctx->lanes[id] = ticks;
+    ctx->active[WORD(id)] |= BIT(id);
+    ctx->pending[WORD(id)] &= ~BIT(id);
+}
+
+/* Disarms a timer */
+void flexitimer_engine_disarm(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    ctx->active[WORD(id)] &= ~BIT(id);
+    ctx->pending[WORD(id)] &= ~BIT(id);
+}
+
+/* Gets the remaining ticks of a timer */
+timer_time_t flexitimer_engine_remaining(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    return ctx->lanes[id];
+}
+
+/* Advances one tick */
+void flexitimer_engine_tick(flexitimer_ctx_t *ctx)
+{
+    uint32_t words = (ctx->capacity + 63u) / 64u;
+    ctx->now++;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        ctx->pending[w] = (ctx->active[w] != 0u) ? soa_tick_word(&ctx->lanes[w * 64u], ctx->active[w]) : 0u;
+    }
+
+    /* Callbacks may cancel or re-arm timers that are still pending, those leave the bitmask */
+    for(uint32_t w = 0; w < words; w++)
+    {
+        while(ctx->pending[w] != 0u)
+        {
+            timer_id_t id = (timer_id_t)((w * 64u) + flexitimer_ctz64(ctx->pending[w]));
+            ctx->pending[w] &= ~BIT(id);
+
+            if(ctx->timers[id].type != TIMER_TYPE_PERIODIC)
+            {
+                ctx->active[w] &= ~BIT(id);
+            }
+
+            flexitimer_expire(ctx, id);
+
+            if(ctx->timers[id].state != TIMER_STATE_ACTIVE)
+            {
+                ctx->active[w] &= ~BIT(id); // a periodic timer left passive, cancelled with its group
+            }
+        }
+    }
+}
+
+/* Gets the ticks until the next expiry */
+timer_time_t flexitimer_engine_next(flexitimer_ctx_t *ctx)
+{
+    uint32_t words = (ctx->capacity + 63u) / 64u;
+    timer_time_t next = 0;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        for(uint64_t bits = ctx->active[w]; bits != 0u; bits &= bits - 1u)
+        {
+            timer_time_t lane = ctx->lanes[(w * 64u) + flexitimer_ctz64(bits)];
+            timer_time_t ticks = (lane > 0u) ? lane : 1u;
+
+            if((next == 0u) || (ticks < next))
+            {
+                next = ticks;
+            }
+        }
+    }
+
+    return next;
+}
+
+/* Skips ticks without expiries */
+void flexitimer_engine_skip(flexitimer_ctx_t *ctx, timer_time_t ticks)
+{
+    uint32_t words = (ctx->capacity + 63u) / 64u;
+
+    if(ticks > 0u)
+    {
+        ctx->now += ticks;
+
+        for(uint32_t w = 0; w < words; w++)
+        {
+            for(uint64_t bits = ctx->active[w]; bits != 0u; bits &= bits - 1u)
+            {
+                ctx->lanes[(w * 64u) + flexitimer_ctz64(bits)] -= ticks;
+            }
+        }
+    }
+}
+
+/* Starts a batch, the arms and disarms need no deferred work */
+void flexitimer_engine_batch_begin(flexitimer_ctx_t *ctx, uint32_t count)
+{
+    (void)ctx;
+    (void)count;
+}
+
+/* Ends a batch */
+void flexitimer_engine_batch_end(flexitimer_ctx_t *ctx)
+{
+    (void)ctx;
+}
+
+#endif // FLEXITIMER_SCAN_SOA
@@ -0,0 +1,264 @@
+/**
+    @file flexitimer_static.c
+    @brief FlexiTimer Scheduler Library - compile-time static timer tables
+
+    The counters count up from zero, so the zeroed RAM of a new table already is a valid state:
+    every timer running towards its phase. A tick compares each counter with the due time read
+    from the read-only entry.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_static.h"
+#include <stddef.h>
+
+#define FLAG_PERIOD     (0x01u)     // first expiry done, the next ones are a period apart
+#define FLAG_PAUSED     (0x02u)
+#define FLAG_STOPPED    (0x04u)     // cancelled or single-shot expired
+
+#define NOT_FOUND       (UINT32_MAX)
+
+/* Gets the ticks from the last start or expiry to the next expiry */
+static timer_time_t static_due(const flexitimer_static_timer_t *timer, uint8_t flags)
+{
+    timer_time_t due = (((flags & FLAG_PERIOD) != 0u) || (timer->phase == 0u)) ? timer->period : timer->phase;
+    return (due > 0u) ? due : 1u;
+}
+
+/* Finds the entry of an id, usually at the index of the same value */
+static uint32_t static_find(const flexitimer_static_t *table, timer_id_t id)
+{
+    if(table == NULL)
+    {
+        return NOT_FOUND;
+    }
+
+    if(((uint32_t)id < table->count) && (table->timers[id].id == id))
+    {
+        return (uint32_t)id;
+    }
+
+    for(uint32_t i = 0; i < table->count; i++)
+    {
+        if(table->timers[i].id == id)
+        {
+            return i;
+        }
+    }
+
+    return NOT_FOUND;
+}
+
+/* Processes one tick of a table */
+void flexitimer_static_handler(const flexitimer_static_t *table)
+{
+    if(table == NULL)
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < table->count; i++)
+    {
+        const flexitimer_static_timer_t *timer = &table->timers[i];
+        flexitimer_static_counter_t *counter = &table->counters[i];
+
+        if((counter->flags & (FLAG_PAUSED | FLAG_STOPPED)) != 0u)
+        {
+            continue;
+        }
+
+        counter->elapsed++;
+
+        if(counter->elapsed >= static_due(timer, counter->flags))
+        {
+            counter->elapsed = 0;
+            counter->flags |= FLAG_PERIOD;
+
+            if(timer->type != (uint8_t)TIMER_TYPE_PERIODIC)
+            {
+                counter->flags |= FLAG_STOPPED;
+            }
+
+            if(timer->callback)
+            {
+                timer->callback(timer->id);
+            }
+        }
+    }
+}
+
+/* Processes several elapsed ticks of a table at once */
+void flexitimer_static_advance(const flexitimer_static_t *table, timer_time_t ticks)
+{
+    if(table == NULL)
+    {
+        return;
+    }
+
+    /* Callbacks may restart other timers, so the next expiry is looked up after every tick */
+    while(ticks > 0u)
+    {
+        timer_time_t next = 0;
+
+        if((flexitimer_static_next_expiry(table, &next) != FLEXITIMER_OK) || (next > ticks))
+        {
+            next = ticks + 1u; // no expiry within the ticks
+        }
+
+        for(uint32_t i = 0; i < table->count; i++)
+        {
+            if((table->counters[i].flags & (FLAG_PAUSED | FLAG_STOPPED)) == 0u)
+            {
+                table->counters[i].elapsed += next - 1u;
+            }
+        }
+
+        if(next > ticks)
+        {
+            break;
+        }
+
+        flexitimer_static_handler(table);
+        ticks -= next;
+    }
+}
+
+/* Gets the ticks until the earliest expiry of a table */
+flexitimer_error_t flexitimer_static_next_expiry(const flexitimer_static_t *table, timer_time_t *ticks)
+{
+    if((table == NULL) || (ticks == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    *ticks = 0;
+
+    for(uint32_t i = 0; i < table->count; i++)
+    {
+        const flexitimer_static_counter_t *counter = &table->counters[i];
+
+        if((counter->flags & (FLAG_PAUSED | FLAG_STOPPED)) == 0u)
+        {
+            timer_time_t remaining = static_due(&table->timers[i], counter->flags) - counter->elapsed;
+
+            if((*ticks == 0u) || (remaining < *ticks))
+            {
+                *ticks = remaining;
+            }
+        }
+    }
+
+    return (*ticks > 0u) ? FLEXITIMER_OK : FLEXITIMER_ERROR_INVALID_STATE;
+}
+
+/* Pauses a static timer */
+flexitimer_error_t flexitimer_static_pause(const flexitimer_static_t *table, timer_id_t id)
+{
+    uint32_t i = static_find(table, id);
+
+    if(i == NOT_FOUND)
+    {
+        return (table == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if((table->counters[i].flags & (FLAG_PAUSED | FLAG_STOPPED)) != 0u)
+    {
+        return FLEXITIMER_ERROR_INVALID_STATE;
+    }
+
+    table->counters[i].flags |= FLAG_PAUSED;
+    return FLEXITIMER_OK;
+}
+
+/* Resumes a static timer */
+flexitimer_error_t flexitimer_static_resume(const flexitimer_static_t *table, timer_id_t id)
+{
+    uint32_t i = static_find(table, id);
+
+    if(i == NOT_FOUND)
+    {
+        return (table == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if((table->counters[i].flags & FLAG_PAUSED) == 0u)
+    {
+        return FLEXITIMER_ERROR_INVALID_STATE;
+    }
+
+    table->counters[i].flags &= (uint8_t)~FLAG_PAUSED;
+    return FLEXITIMER_OK;
+}
+
+/* Restarts a static timer from a full period */
+flexitimer_error_t flexitimer_static_restart(const flexitimer_static_t *table, timer_id_t id)
+{
+    uint32_t i = static_find(table, id);
+
+    if(i == NOT_FOUND)
+    {
+        return (table == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    table->counters[i].elapsed = 0;
+    table->counters[i].flags = FLAG_PERIOD;
+    return FLEXITIMER_OK;
+}
+
+/* Cancels a static timer */
+flexitimer_error_t flexitimer_static_cancel(const flexitimer_static_t *table, timer_id_t id)
+{
+    uint32_t i = static_find(table, id);
+
+    if(i == NOT_FOUND)
+    {
+        return (table == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    table->counters[i].elapsed = 0;
+    table->counters[i].flags = FLAG_PERIOD | FLAG_STOPPED;
+    return FLEXITIMER_OK;
+}
+
+/* Gets the state of a static timer */
+flexitimer_error_t flexitimer_static_get_state(const flexitimer_static_t *table, timer_id_t id, timer_state_t *state)
+{
+    uint32_t i = static_find(table, id);
+
+    if(i == NOT_FOUND)
+    {
+        return (table == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if(state == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    uint8_t flags = table->counters[i].flags;
+    *state = ((flags & FLAG_STOPPED) != 0u) ? TIMER_STATE_PASSIVE : (((flags & FLAG_PAUSED) != 0u) ? TIMER_STATE_PAUSED : TIMER_STATE_ACTIVE);
+    return FLEXITIMER_OK;
+}
+
+/* Gets the remaining time of a static timer */
+flexitimer_error_t flexitimer_static_get_elapsed(const flexitimer_static_t *table, timer_id_t id, timer_time_t *time)
+{
+    uint32_t i = static_find(table, id);
+
+    if(i == NOT_FOUND)
+    {
+        return (table == NULL) ? FLEXITIMER_ERROR_INVALID_ARG : FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    if(time == NULL)
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    const flexitimer_static_counter_t *counter = &table->counters[i];
+    *time = ((counter->flags & FLAG_STOPPED) != 0u) ? 0u : (static_due(&table->timers[i], counter->flags) - counter->elapsed);
+    return FLEXITIMER_OK;
+}
@@ -0,0 +1,120 @@
+/**
+    @file flexitimer_stats.c
+    @brief FlexiTimer Scheduler Library - runtime statistics
+
+    Per timer fire and overrun counters, callback durations and a log2 histogram of them,
+    accounted on every expiration when FLEXITIMER_STATS is enabled. The durations come from
+    a clock hook of the context, so the unit is whatever the platform provides.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+#include <stdio.h> // for NULL
+
+#if FLEXITIMER_STATS
+
+/* Gets the histogram bucket of a duration */
+static uint32_t stats_bucket(uint64_t duration)
+{
+    uint32_t bucket = 0;
+
+    while((duration != 0u) && (bucket < (FLEXITIMER_STATS_BUCKETS - 1u)))
+    {
+        duration >>= 1u;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/* Accounts one expiration of a timer */
+void flexitimer_stats_record(flexitimer_ctx_t *ctx, timer_id_t id, uint64_t duration)
+{
+    flexitimer_stats_t *stats = &ctx->timers[id].stats;
+    stats->fires++;
+    stats->total_time += duration;
+    stats->histogram[stats_bucket(duration)]++;
+
+    if(duration > stats->max_time)
+    {
+        stats->max_time = duration;
+    }
+
+    if(duration > ctx->overrun_limit)
+    {
+        stats->overruns++;
+    }
+}
+
+/* Sets the clock that times the callbacks */
+void flexitimer_ctx_set_clock(flexitimer_ctx_t *ctx, flexitimer_clock_t clock, uint64_t overrun_limit)
+{
+    if(ctx != NULL)
+    {
+        ctx->clock = clock;
+        ctx->overrun_limit = overrun_limit;
+    }
+}
+
+/* Gets the runtime statistics of a timer */
+flexitimer_error_t flexitimer_ctx_get_stats(flexitimer_ctx_t *ctx, timer_id_t id, flexitimer_stats_t *stats)
+{
+    if((ctx == NULL) || (stats == NULL))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    if(id >= ctx->capacity)
+    {
+        return FLEXITIMER_ERROR_INVALID_ID;
+    }
+
+    *stats = ctx->timers[id].stats;
+    return FLEXITIMER_OK;
+}
+
+/* Clears the runtime statistics of all timers */
+void flexitimer_ctx_reset_stats(flexitimer_ctx_t *ctx)
+{
+    if(ctx != NULL)
+    {
+        for(uint32_t i = 0; i < ctx->capacity; i++)
+        {
+            flexitimer_stats_t *stats = &ctx->timers[i].stats;
+            stats->fires = 0;
+            stats->overruns = 0;
+            stats->total_time = 0;
+            stats->max_time = 0;
+
+            for(uint32_t b = 0; b < FLEXITIMER_STATS_BUCKETS; b++)
+            {
+                stats->histogram[b] = 0;
+            }
+        }
+    }
+}
+
+/* Sets the clock of the default context */
+void flexitimer_set_clock(flexitimer_clock_t clock, uint64_t overrun_limit)
+{
+    flexitimer_ctx_set_clock(flexitimer_default_ctx(), clock, overrun_limit);
+}
+
+/* Gets the runtime statistics of a timer of the default context */
+flexitimer_error_t flexitimer_get_stats(timer_id_t id, flexitimer_stats_t *stats)
+{
+    return flexitimer_ctx_get_stats(flexitimer_default_ctx(), id, stats);
+}
+
+/* Clears the runtime statistics of the default context */
+void flexitimer_reset_stats(void)
+{
+    flexitimer_ctx_reset_stats(flexitimer_default_ctx());
+}
+
+#endif // FLEXITIMER_STATS
@@ -0,0 +1,89 @@
+/**
+    @file flexitimer_trace.c
+    @brief FlexiTimer Scheduler Library - binary event trace
+
+    Ring buffer of fixed size binary events, written by the thread running the context only.
+    The writer fills the slot of the next event and then publishes it by advancing the head
+    counter, so recording needs no atomic read-modify-write. A reader copies the slots below
+    the head and reads the head again afterwards, the slots the writer reached meanwhile hold
+    newer events and are dropped from the copy.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+#include <stdio.h> // for NULL
+
+#if FLEXITIMER_TRACE
+
+/* Sets the trace buffer of a context */
+flexitimer_error_t flexitimer_ctx_set_trace(flexitimer_ctx_t *ctx, flexitimer_trace_event_t *buffer, uint32_t count, flexitimer_clock_t clock)
+{
+    if((ctx == NULL) || ((buffer != NULL) && ((count == 0u) || ((count & (count - 1u)) != 0u))))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    ctx->trace = buffer;
+    ctx->trace_mask = (buffer != NULL) ? (count - 1u) : 0u;
+    ctx->trace_clock = clock;
+    __atomic_store_n(&ctx->trace_head, 0u, __ATOMIC_RELEASE);
+    return FLEXITIMER_OK;
+}
+
+/* Copies the latest events of a context, oldest first */
+uint32_t flexitimer_ctx_trace_read(const flexitimer_ctx_t *ctx, flexitimer_trace_event_t *events, uint32_t count)
+{
+    if((ctx == NULL) || (ctx->trace == NULL) || (events == NULL))
+    {
+        return 0u;
+    }
+
+    uint32_t size = ctx->trace_mask + 1u;
+    uint32_t head = __atomic_load_n(&ctx->trace_head, __ATOMIC_ACQUIRE);
+    uint32_t available = (head < size) ? head : size;
+    uint32_t copied = (count < available) ? count : available;
+    uint32_t first = head - copied;
+
+    for(uint32_t i = 0; i < copied; i++)
+    {
+        events[i] = ctx->trace[(first + i) & ctx->trace_mask];
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE); // the copy is read before the head
+
+    /* Every event recorded meanwhile, and the one being recorded, replaced the one a buffer size before it */
+    uint32_t latest = __atomic_load_n(&ctx->trace_head, __ATOMIC_RELAXED);
+
+    if((latest - first) >= size)
+    {
+        uint32_t dropped = (latest - first) - size + 1u;
+        dropped = (dropped < copied) ? dropped : copied;
+        copied -= dropped;
+
+        for(uint32_t i = 0; i < copied; i++)
+        {
+            events[i] = events[i + dropped];
+        }
+    }
+
+    return copied;
+}
+
+/* Sets the trace buffer of the default context */
+flexitimer_error_t flexitimer_set_trace(flexitimer_trace_event_t *buffer, uint32_t count, flexitimer_clock_t clock)
+{
+    return flexitimer_ctx_set_trace(flexitimer_default_ctx(), buffer, count, clock);
+}
+
+/* Copies the latest events of the default context */
+uint32_t flexitimer_trace_read(flexitimer_trace_event_t *events, uint32_t count)
+{
+    return flexitimer_ctx_trace_read(flexitimer_default_ctx(), events, count);
+}
+
+#endif // FLEXITIMER_TRACE
@@ -0,0 +1,361 @@
+/**
+    @file flexitimer_wheel.c
+    @brief FlexiTimer Scheduler Library - hierarchical timing wheel engine
+
+    Timers are kept in WHEEL_LEVELS wheels of WHEEL_SIZE slots, each slot being an intrusive
+    doubly linked list. Level 0 holds the timers expiring within the next WHEEL_SIZE ticks, one
+    slot per tick, every further level covers WHEEL_SIZE times the range of the previous one.
+    When level 0 wraps around, the current slot of the next level is cascaded down.
+    Arming and disarming are O(1), a tick only touches the timers that expire or cascade.
+    Skipped ticks only stop at the cascades of occupied slots, so an idle wheel skips any
+    number of ticks in one step.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include "flexitimer_internal.h"
+
+#if FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_WHEEL
+
+#define WHEEL_BITS      FLEXITIMER_WHEEL_BITS
+#define WHEEL_SIZE      FLEXITIMER_WHEEL_SIZE
+#define WHEEL_MASK      (WHEEL_SIZE - 1u)
+#define WHEEL_LEVELS    FLEXITIMER_WHEEL_LEVELS
+#define WHEEL_HEADS     (WHEEL_LEVELS * WHEEL_SIZE)
+
+/* List nodes: timers first, then the slot heads, then the list of timers due on this tick */
+#define NODE_HEAD(level, slot)  (ctx->capacity + ((level) * WHEEL_SIZE) + (slot))
+#define NODE_PENDING            (ctx->capacity + WHEEL_HEADS)
+#define NODE_NONE               ((flexitimer_node_t)UINT32_MAX)
+
+static flexitimer_link_t *node_link(flexitimer_ctx_t *ctx, flexitimer_node_t node)
+{
+    return (node < ctx->capacity) ? &ctx->timers[node].link : &ctx->heads[node - ctx->capacity];
+}
+
+static void list_init(flexitimer_ctx_t *ctx, flexitimer_node_t head)
+{
+    node_link(ctx, head)->next = head;
+    node_link(ctx, head)->prev = head;
+}
+
+static void list_append(flexitimer_ctx_t *ctx, flexitimer_node_t head, flexitimer_node_t node)
+{
+    flexitimer_node_t tail = node_link(ctx, head)->prev;
+    node_link(ctx, node)->next = head;
+    node_link(ctx, node)->prev = tail;
+    node_link(ctx, tail)->next = node;
+    node_link(ctx, head)->prev = node;
+}
+
+static void list_unlink(flexitimer_ctx_t *ctx, flexitimer_node_t node)
+{
+    flexitimer_node_t next = node_link(ctx, node)->next;
+    flexitimer_node_t prev = node_link(ctx, node)->prev;
+    node_link(ctx, prev)->next = next;
+    node_link(ctx, next)->prev = prev;
+}
+
+/* Moves all nodes of one list to the end of another */
+static void list_splice(flexitimer_ctx_t *ctx, flexitimer_node_t from, flexitimer_node_t to)
+{
+    flexitimer_node_t first = node_link(ctx, from)->next;
+
+    if(first != from)
+    {
+        flexitimer_node_t last = node_link(ctx, from)->prev;
+        flexitimer_node_t tail = node_link(ctx, to)->prev;
+        node_link(ctx, tail)->next = first;
+        node_link(ctx, first)->prev = tail;
+        node_link(ctx, last)->next = to;
+        node_link(ctx, to)->prev = last;
+        list_init(ctx, from);
+    }
+}
+
+/* Places a timer into the slot of the given expiry tick, relative to the next tick to process */
+static void wheel_insert(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t when)
+{
+    timer_time_t delta = when - (ctx->now + 1u);
+    uint32_t level = 0;
+
+    while((level < (WHEEL_LEVELS - 1u)) && ((delta >> (WHEEL_BITS * (level + 1u))) != 0u))
+    {
+        level++;
+    }
+
+    list_append(ctx, NODE_HEAD(level, (when >> (WHEEL_BITS * level)) & WHEEL_MASK), id);
+}
+
+/* Redistributes the timers of a higher level slot to the lower levels */
+static void wheel_cascade(flexitimer_ctx_t *ctx, uint32_t level, uint32_t slot)
+{
+    flexitimer_node_t head = NODE_HEAD(level, slot);
+
+    while(node_link(ctx, head)->next != head)
+    {
+        flexitimer_node_t node = node_link(ctx, head)->next;
+        list_unlink(ctx, node);
+        wheel_insert(ctx, (timer_id_t)node, ctx->timers[node].expiry);
+    }
+}
+
+/* Cascades the higher level slots that are due when the given tick is processed */
+static void wheel_cascade_tick(flexitimer_ctx_t *ctx, timer_time_t base)
+{
+    uint32_t level = 1;
+
+    while((level < WHEEL_LEVELS) && (((base >> (WHEEL_BITS * (level - 1u))) & WHEEL_MASK) == 0u))
+    {
+        wheel_cascade(ctx, level, (base >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        level++;
+    }
+}
+
+/* Sorts the timers due on this tick by id, bottom-up merge sort on the list */
+static void wheel_sort_pending(flexitimer_ctx_t *ctx)
+{
+    flexitimer_node_t head = NODE_PENDING;
+    flexitimer_node_t list = node_link(ctx, head)->next;
+    uint32_t size = 1;
+    uint32_t merges = 0;
+
+    if(list == node_link(ctx, head)->prev)
+    {
+        return; // 0 or 1 timer
+    }
+
+    node_link(ctx, node_link(ctx, head)->prev)->next = NODE_NONE;
+
+    do
+    {
+        flexitimer_node_t p = list;
+        flexitimer_node_t tail = NODE_NONE;
+        list = NODE_NONE;
+        merges = 0;
+
+        while(p != NODE_NONE)
+        {
+            flexitimer_node_t q = p;
+            uint32_t psize = 0;
+            uint32_t qsize = size;
+            merges++;
+
+            while((psize < size) && (q != NODE_NONE))
+            {
+                psize++;
+                q = node_link(ctx, q)->next;
+            }
+
+            while((psize > 0u) || ((qsize > 0u) && (q != NODE_NONE)))
+            {
+                flexitimer_node_t e;
+
+                if((psize > 0u) && ((qsize == 0u) || (q == NODE_NONE) || (p < q)))
+                {
+                    e = p;
+                    p = node_link(ctx, p)->next;
+                    psize--;
+                }
+                else
+                {
+                    e = q;
+                    q = node_link(ctx, q)->next;
+                    qsize--;
+                }
+
+                if(tail != NODE_NONE)
+                {
+                    node_link(ctx, tail)->next = e;
+                }
+                else
+                {
+                    list = e;
+                }
+
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        node_link(ctx, tail)->next = NODE_NONE;
+        size *= 2u;
+    }
+    while(merges > 1u);
+
+    /* Rebuild the circular doubly linked list */
+    flexitimer_node_t prev = head;
+    node_link(ctx, head)->next = list;
+
+    for(flexitimer_node_t node = list; node != NODE_NONE; node = node_link(ctx, node)->next)
+    {
+        node_link(ctx, node)->prev = prev;
+        prev = node;
+    }
+
+    node_link(ctx, prev)->next = head;
+    node_link(ctx, head)->prev = prev;
+}
+
+/* Resets the engine */
+void flexitimer_engine_init(flexitimer_ctx_t *ctx)
+{
+    for(flexitimer_node_t i = 0; i <= WHEEL_HEADS; i++)
+    {
+        list_init(ctx, NODE_HEAD(0u, 0u) + i);
+    }
+
+    ctx->now = 0;
+}
+
+/* Arms a timer */
+void flexitimer_engine_arm(flexitimer_ctx_t *ctx, timer_id_t id, timer_time_t ticks)
+{
+    ctx->timers[id].expiry = ctx->now + ticks;
+    ctx->timers[id].remaining = ticks;
+    wheel_insert(ctx, id, (ticks == 0u) ? (ctx->now + 1u) : ctx->timers[id].expiry);
+}
+
+/* Disarms a timer */
+void flexitimer_engine_disarm(flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    list_unlink(ctx, id);
+}
+
+/* Gets the remaining ticks of a timer */
+timer_time_t flexitimer_engine_remaining(const flexitimer_ctx_t *ctx, timer_id_t id)
+{
+    /* A timer armed with 0 ticks is due on the next tick and reports 0 until it expires */
+    return (ctx->timers[id].remaining == 0u) ? 0u : (ctx->timers[id].expiry - ctx->now);
+}
+
+/* Advances one tick */
+void flexitimer_engine_tick(flexitimer_ctx_t *ctx)
+{
+    timer_time_t base = ctx->now + 1u;
+    wheel_cascade_tick(ctx, base);
+    list_splice(ctx, NODE_HEAD(0u, base & WHEEL_MASK), NODE_PENDING);
+    ctx->now = base;
+    wheel_sort_pending(ctx);
+
+    /* Callbacks may cancel or re-arm timers that are still pending, those leave the list */
+    while(node_link(ctx, NODE_PENDING)->next != NODE_PENDING)
+    {
+        flexitimer_node_t node = node_link(ctx, NODE_PENDING)->next;
+        list_unlink(ctx, node);
+        flexitimer_expire(ctx, (timer_id_t)node);
+    }
+}
+
+/* Gets the ticks until the next expiry */
+timer_time_t flexitimer_engine_next(flexitimer_ctx_t *ctx)
+{
+    timer_time_t base = ctx->now + 1u;
+    timer_time_t next = 0;
+
+    /* Level 0 slots are one tick each, the first used one is the earliest of the level */
+    for(uint32_t i = 0; i < WHEEL_SIZE; i++)
+    {
+        if(node_link(ctx, NODE_HEAD(0u, (base + i) & WHEEL_MASK))->next != NODE_HEAD(0u, (base + i) & WHEEL_MASK))
+        {
+            next = i + 1u;
+            break;
+        }
+    }
+
+    /* Higher levels start at the first slot not cascaded yet, but may still hold an earlier expiry */
+    for(uint32_t level = 1; level < WHEEL_LEVELS; level++)
+    {
+        uint32_t first = (ctx->now >> (WHEEL_BITS * level)) + 1u;
+
+        for(uint32_t i = 0; i < WHEEL_SIZE; i++)
+        {
+            flexitimer_node_t head = NODE_HEAD(level, (first + i) & WHEEL_MASK);
+
+            if(node_link(ctx, head)->next != head)
+            {
+                for(flexitimer_node_t node = node_link(ctx, head)->next; node != head; node = node_link(ctx, node)->next)
+                {
+                    timer_time_t ticks = ctx->timers[node].expiry - ctx->now;
+
+                    if((next == 0u) || (ticks < next))
+                    {
+                        next = ticks;
+                    }
+                }
+
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+/* Gets the ticks until the next tick that cascades an occupied slot, UINT64_MAX if none does */
+static uint64_t wheel_next_cascade(flexitimer_ctx_t *ctx)
+{
+    uint64_t next = UINT64_MAX;
+
+    for(uint32_t level = 1; level < WHEEL_LEVELS; level++)
+    {
+        uint32_t shift = WHEEL_BITS * level;
+        uint64_t first = ((uint64_t)ctx->now >> shift) + 1u;
+
+        for(uint32_t i = 0; i < WHEEL_SIZE; i++)
+        {
+            /* The slot of the tick count as it wraps around, the top level has fewer slots in use */
+            timer_time_t base = (timer_time_t)((first + i) << shift);
+            flexitimer_node_t head = NODE_HEAD(level, (base >> shift) & WHEEL_MASK);
+
+            if(node_link(ctx, head)->next != head)
+            {
+                uint64_t ticks = ((first + i) << shift) - ctx->now;
+                next = (ticks < next) ? ticks : next;
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+/* Skips ticks without expiries, jumping from one cascade of an occupied slot to the next */
+void flexitimer_engine_skip(flexitimer_ctx_t *ctx, timer_time_t ticks)
+{
+    while(ticks > 0u)
+    {
+        uint64_t step = wheel_next_cascade(ctx);
+
+        if(step > ticks)
+        {
+            ctx->now += ticks;
+            break;
+        }
+
+        ctx->now += (timer_time_t)step - 1u;
+        wheel_cascade_tick(ctx, ctx->now + 1u);
+        ctx->now++;
+        ticks -= (timer_time_t)step;
+    }
+}
+
+/* Starts a batch, the arms and disarms need no deferred work */
+void flexitimer_engine_batch_begin(flexitimer_ctx_t *ctx, uint32_t count)
+{
+    (void)ctx;
+    (void)count;
+}
+
+/* Ends a batch */
+void flexitimer_engine_batch_end(flexitimer_ctx_t *ctx)
+{
+    (void)ctx;
+}
+
+#endif // FLEXITIMER_ENGINE_WHEEL
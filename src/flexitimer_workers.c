@@ -0,0 +1,196 @@
+/**
+    @file flexitimer_workers.c
+    @brief FlexiTimer Scheduler Library - callback worker pool
+
+    The handler thread links every expired DEFERRED timer into a batch through its slot, without
+    locking, and counts repeated expirations instead of linking the slot twice. A flush takes the
+    lock once, adds the counts to the owed expirations and appends the timers that are neither
+    queued nor running to the run queue. A worker takes a timer off the queue and runs its owed
+    expirations until none is left, so each timer is on the queue, and with a worker, only once.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "flexitimer_workers.h"
+#include "flexitimer_internal.h"
+#include <errno.h>
+
+#define NODE_NONE ((flexitimer_node_t)UINT32_MAX)
+
+/* Collects an expiration, called by the handler */
+static void workers_submit(void *arg, timer_id_t id, timer_callback_t callback)
+{
+    flexitimer_workers_t *workers = (flexitimer_workers_t *)arg;
+    flexitimer_worker_slot_t *slot = &workers->slots[id];
+
+    if(slot->fires == 0u)
+    {
+        slot->batch_next = workers->batch;
+        workers->batch = id;
+    }
+
+    slot->fires++;
+    slot->batched = callback;
+}
+
+/* Hands the collected batch over to the workers, called by the handler */
+static void workers_flush(void *arg)
+{
+    flexitimer_workers_t *workers = (flexitimer_workers_t *)arg;
+
+    if(workers->batch == NODE_NONE)
+    {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&workers->lock);
+
+    for(flexitimer_node_t id = workers->batch; id != NODE_NONE; id = workers->slots[id].batch_next)
+    {
+        flexitimer_worker_slot_t *slot = &workers->slots[id];
+        slot->owed += slot->fires;
+        slot->callback = slot->batched;
+        slot->fires = 0;
+
+        if(slot->queued == 0u)
+        {
+            slot->queued = 1u;
+            slot->next = NODE_NONE;
+
+            if(workers->head == NODE_NONE)
+            {
+                workers->head = id;
+            }
+            else
+            {
+                workers->slots[workers->tail].next = id;
+            }
+
+            workers->tail = id;
+        }
+    }
+
+    (void)pthread_mutex_unlock(&workers->lock);
+    (void)pthread_cond_broadcast(&workers->ready);
+    workers->batch = NODE_NONE;
+}
+
+/* Worker thread body */
+static void *workers_thread(void *arg)
+{
+    flexitimer_workers_t *workers = (flexitimer_workers_t *)arg;
+    (void)pthread_mutex_lock(&workers->lock);
+
+    for(;;)
+    {
+        while((workers->head == NODE_NONE) && (workers->running != 0u))
+        {
+            (void)pthread_cond_wait(&workers->ready, &workers->lock);
+        }
+
+        if(workers->head == NODE_NONE)
+        {
+            break; // stopped and drained
+        }
+
+        flexitimer_node_t id = workers->head;
+        flexitimer_worker_slot_t *slot = &workers->slots[id];
+        workers->head = slot->next;
+
+        while(slot->owed > 0u)
+        {
+            timer_callback_t callback = slot->callback;
+            slot->owed--;
+            (void)pthread_mutex_unlock(&workers->lock);
+            callback((timer_id_t)id);
+            (void)pthread_mutex_lock(&workers->lock);
+        }
+
+        slot->queued = 0u;
+    }
+
+    (void)pthread_mutex_unlock(&workers->lock);
+    return NULL;
+}
+
+/* Starts a worker pool */
+flexitimer_error_t flexitimer_workers_init(flexitimer_workers_t *workers, flexitimer_ctx_t *ctx, flexitimer_worker_slot_t *slots, uint32_t count)
+{
+    if((workers == NULL) || (slots == NULL) || (count == 0u) || (count > FLEXITIMER_WORKERS_MAX))
+    {
+        return FLEXITIMER_ERROR_INVALID_ARG;
+    }
+
+    workers->ctx = (ctx != NULL) ? ctx : flexitimer_default_ctx();
+    workers->slots = slots;
+    workers->count = 0;
+    workers->head = NODE_NONE;
+    workers->tail = NODE_NONE;
+    workers->batch = NODE_NONE;
+    workers->running = 1u;
+
+    for(uint32_t i = 0; i < workers->ctx->capacity; i++)
+    {
+        slots[i].callback = NULL;
+        slots[i].owed = 0;
+        slots[i].next = NODE_NONE;
+        slots[i].queued = 0u;
+        slots[i].batched = NULL;
+        slots[i].fires = 0;
+        slots[i].batch_next = NODE_NONE;
+    }
+
+    (void)pthread_mutex_init(&workers->lock, NULL);
+    (void)pthread_cond_init(&workers->ready, NULL);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        int result = pthread_create(&workers->threads[i], NULL, workers_thread, workers);
+
+        if(result != 0)
+        {
+            flexitimer_workers_deinit(workers);
+            errno = result;
+            return FLEXITIMER_ERROR_SYSTEM;
+        }
+
+        workers->count++;
+    }
+
+    flexitimer_dispatcher_t dispatcher = {workers_submit, workers_flush, workers};
+    flexitimer_ctx_set_dispatcher(workers->ctx, &dispatcher);
+    return FLEXITIMER_OK;
+}
+
+/* Stops a worker pool */
+void flexitimer_workers_deinit(flexitimer_workers_t *workers)
+{
+    if(workers == NULL)
+    {
+        return;
+    }
+
+    flexitimer_ctx_set_dispatcher(workers->ctx, NULL);
+    workers_flush(workers);
+    (void)pthread_mutex_lock(&workers->lock);
+    workers->running = 0u;
+    (void)pthread_mutex_unlock(&workers->lock);
+    (void)pthread_cond_broadcast(&workers->ready);
+
+    for(uint32_t i = 0; i < workers->count; i++)
+    {
+        (void)pthread_join(workers->threads[i], NULL);
+    }
+
+    workers->count = 0;
+    (void)pthread_cond_destroy(&workers->ready);
+    (void)pthread_mutex_destroy(&workers->lock);
+}
+
+#endif // __unix__ || __APPLE__
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "flexitimer_coro.hpp"
+
+class FlexiTimerCoroTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        flexitimer_init();
+        ASSERT_EQ(flexitimer::coro_slots(2, 3), FLEXITIMER_OK); // ids 0 and 1 stay with plain timers
+        steps.clear();
+    }
+
+    std::vector<timer_time_t> steps;
+};
+
+/* Records the tick of each step of a power cycle */
+static flexitimer::task power_cycle(std::vector<timer_time_t> &steps)
+{
+    timer_time_t now = 0;
+
+    for(timer_time_t ticks : {1u, 10u, 3u})
+    {
+        EXPECT_EQ(co_await flexitimer::sleep_for(ticks), FLEXITIMER_OK);
+        (void)flexitimer_get_now(&now);
+        steps.push_back(now);
+    }
+}
+
+TEST_F(FlexiTimerCoroTest, SleepForResumesFromTheHandler)
+{
+    flexitimer::task cycle = power_cycle(steps);
+    timer_time_t next = 0;
+
+    ASSERT_EQ(flexitimer_next_expiry(&next), FLEXITIMER_OK);
+    EXPECT_EQ(next, 1u);
+    flexitimer_handler();
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {1}));
+
+    for(int i = 0; i < 9; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(steps.size(), 1u);
+    flexitimer_handler();
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {1, 11}));
+    flexitimer_advance(10); // advance resumes on the tick of the expiry
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {1, 11, 14}));
+    EXPECT_TRUE(cycle.done());
+    EXPECT_EQ(flexitimer_next_expiry(&next), FLEXITIMER_ERROR_INVALID_STATE);
+}
+
+/* Waits for the given deadlines */
+static flexitimer::task wait_until(std::vector<timer_time_t> &steps, std::vector<timer_time_t> deadlines)
+{
+    timer_time_t now = 0;
+
+    for(timer_time_t deadline : deadlines)
+    {
+        EXPECT_EQ(co_await flexitimer::until(deadline), FLEXITIMER_OK);
+        (void)flexitimer_get_now(&now);
+        steps.push_back(now);
+    }
+}
+
+TEST_F(FlexiTimerCoroTest, UntilResumesOnTheDeadline)
+{
+    flexitimer_advance(5);
+    flexitimer::task waits = wait_until(steps, {3, 5, 8, 20});
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {5, 5})); // passed deadlines do not suspend
+
+    flexitimer_advance(30);
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {5, 5, 8, 20}));
+    EXPECT_TRUE(waits.done());
+}
+
+/* Counts the expiries of a ticker, busy for a while after the first one */
+static flexitimer::task count_ticks(std::vector<timer_time_t> &steps, flexitimer::ticker &ticks)
+{
+    timer_time_t now = 0;
+
+    for(int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(co_await ticks.next(), FLEXITIMER_OK);
+        (void)flexitimer_get_now(&now);
+        steps.push_back(now);
+
+        if(i == 0)
+        {
+            (void)co_await flexitimer::sleep_for(7);
+        }
+    }
+}
+
+/* Waits for a ticker once */
+static flexitimer::task expect_next(flexitimer::ticker &ticks, flexitimer_error_t expected)
+{
+    EXPECT_EQ(co_await ticks.next(), expected);
+}
+
+TEST_F(FlexiTimerCoroTest, TickerKeepsExpiriesWhileBusy)
+{
+    flexitimer::ticker ticks;
+    ASSERT_EQ(ticks.start(3), FLEXITIMER_OK);
+    EXPECT_EQ(ticks.start(3), FLEXITIMER_ERROR_INVALID_STATE);
+    flexitimer::task counter = count_ticks(steps, ticks);
+
+    flexitimer_advance(12);
+#if FLEXITIMER_PRIORITIES
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {3, 10, 10, 12}));
+#else
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {3, 9, 9, 12})); // the sleep, a higher id, counts down on the tick it starts
+#endif
+    EXPECT_TRUE(counter.done());
+
+    ticks.stop();
+    flexitimer::task stopped = expect_next(ticks, FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_TRUE(stopped.done());
+}
+
+/* Sleeps once and records whether it woke up */
+static flexitimer::task nap(std::vector<timer_time_t> &steps, flexitimer_error_t expected)
+{
+    EXPECT_EQ(co_await flexitimer::sleep_for(5), expected);
+    steps.push_back(1);
+}
+
+TEST_F(FlexiTimerCoroTest, SlotsAreSharedAndFreed)
+{
+    timer_state_t state;
+    std::vector<flexitimer::task> naps;
+
+    for(int i = 0; i < 3; i++)
+    {
+        naps.push_back(nap(steps, FLEXITIMER_OK));
+    }
+
+    naps.push_back(nap(steps, FLEXITIMER_ERROR_FULL)); // all three slots taken
+    EXPECT_EQ(steps, (std::vector<timer_time_t> {1}));
+    ASSERT_EQ(flexitimer_get_state(0, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+
+    /* Destroying a waiting coroutine cancels its timer and frees the slot */
+    naps.erase(naps.begin());
+    ASSERT_EQ(flexitimer_get_state(2, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+    naps.push_back(nap(steps, FLEXITIMER_OK));
+    ASSERT_EQ(flexitimer_get_state(2, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_ACTIVE);
+
+    flexitimer_advance(5);
+    EXPECT_EQ(steps.size(), 4u);
+
+    for(const flexitimer::task &t : naps)
+    {
+        EXPECT_TRUE(t.done());
+    }
+
+    EXPECT_EQ(flexitimer::coro_slots(8, 3), FLEXITIMER_ERROR_INVALID_ID);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "flexitimer.hpp"
+
+static_assert(std::is_same<flexitimer::counter_t<25>, uint8_t>::value, "25 ticks fit a byte");
+static_assert(std::is_same<flexitimer::counter_t<256>, uint16_t>::value, "256 ticks need two bytes");
+static_assert(std::is_same<flexitimer::counter_t<70000>, timer_time_t>::value, "70000 ticks need a full counter");
+
+extern "C" {
+    static std::vector<timer_id_t> c_fired;
+    void record_callback(timer_id_t id)
+    {
+        c_fired.push_back(id);
+    }
+}
+
+/* Expirations of a periodic timer over a number of ticks, evaluated at compile time */
+static constexpr int constexpr_fires(timer_time_t ticks)
+{
+    struct Count
+    {
+        int fires;
+        constexpr void operator()(timer_id_t)
+        {
+            fires++;
+        }
+    };
+
+    flexitimer::Scheduler<2, uint8_t, Count> scheduler(Count{0});
+    (void)scheduler.start(1, TIMER_TYPE_PERIODIC, 3);
+    scheduler.advance(ticks);
+    return scheduler.policy().fires;
+}
+
+static_assert(constexpr_fires(10) == 3, "the scheduler runs in constant expressions");
+
+TEST(FlexiTimerCppTest, CallbacksInlineInIdOrder)
+{
+    std::vector<int> fired;
+    auto scheduler = flexitimer::make_scheduler<10>(
+        [&fired](timer_id_t id) { fired.push_back(id); },
+        [&fired](timer_id_t id) { fired.push_back(10 + id); },
+        [&fired](timer_id_t id) { fired.push_back(20 + id); });
+
+    static_assert(sizeof(decltype(scheduler)::time_type) == 1u, "counters of timeouts up to 10 are bytes");
+    EXPECT_EQ(scheduler.start(2, TIMER_TYPE_SINGLESHOT, 2), FLEXITIMER_OK);
+    EXPECT_EQ(scheduler.start(0, TIMER_TYPE_SINGLESHOT, 2), FLEXITIMER_OK);
+    EXPECT_EQ(scheduler.start(1, TIMER_TYPE_PERIODIC, 1), FLEXITIMER_OK);
+
+    scheduler.handler();
+    scheduler.handler();
+    EXPECT_EQ(fired, (std::vector<int> {11, 0, 11, 22}));
+}
+
+TEST(FlexiTimerCppTest, CallbacksOperateOnTheScheduler)
+{
+    std::vector<int> lights;
+    auto scheduler = flexitimer::make_scheduler<15>(
+        [&lights](auto &s, timer_id_t) { lights.push_back(0); (void)s.start(1, TIMER_TYPE_SINGLESHOT, 8); },
+        [&lights](auto &s, timer_id_t) { lights.push_back(1); (void)s.start(2, TIMER_TYPE_SINGLESHOT, 2); },
+        [&lights](auto &s, timer_id_t) { lights.push_back(2); (void)s.start(0, TIMER_TYPE_SINGLESHOT, 15); });
+
+    ASSERT_EQ(scheduler.start(2, TIMER_TYPE_SINGLESHOT, 0), FLEXITIMER_OK);
+    scheduler.advance(1 + 15 + 7 + 1); // a timer started by a lower id counts down on the same tick, as with SCAN
+    EXPECT_EQ(lights, (std::vector<int> {2, 0, 1, 2}));
+
+    timer_time_t next = 0;
+    EXPECT_EQ(scheduler.next_expiry(&next), FLEXITIMER_OK);
+    EXPECT_EQ(next, 15u);
+}
+
+TEST(FlexiTimerCppTest, ErrorsMatchTheCApi)
+{
+    auto scheduler = flexitimer::make_scheduler<300>(record_callback, record_callback);
+    timer_state_t state;
+    timer_time_t time;
+
+    EXPECT_EQ(scheduler.start(2, TIMER_TYPE_SINGLESHOT, 1), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(scheduler.start(0, TIMER_TYPE_PERIODIC, 0), FLEXITIMER_ERROR_ZERO_TIMEOUT);
+    EXPECT_EQ(scheduler.restart(0), FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_EQ(scheduler.delay(0, 1), FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_EQ(scheduler.next_expiry(&time), FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_EQ(scheduler.get_state(0, nullptr), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(scheduler.get_state(5, &state), FLEXITIMER_ERROR_INVALID_ID);
+
+    EXPECT_EQ(scheduler.start(0, TIMER_TYPE_PERIODIC, 300), FLEXITIMER_OK);
+    EXPECT_EQ(scheduler.delay(0, UINT16_MAX), FLEXITIMER_ERROR_INVALID_ARG); // counters are 16-bit
+    EXPECT_EQ(scheduler.resume(0), FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_EQ(scheduler.cancel(0), FLEXITIMER_OK);
+    EXPECT_EQ(scheduler.restart(0), FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_EQ(scheduler.get_state(0, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+}
+
+TEST(FlexiTimerCppTest, MatchesTheCApi)
+{
+    constexpr timer_id_t count = 8;
+    flexitimer_ctx_t ctx;
+    flexitimer_timer_t storage[count];
+    std::vector<timer_id_t> fired;
+    auto record = [&fired](timer_id_t id) { fired.push_back(id); };
+    flexitimer::Scheduler<count, flexitimer::counter_t<1000>, decltype(record)> scheduler(record);
+    std::mt19937 random(7);
+
+    ASSERT_EQ(flexitimer_ctx_init(&ctx, storage, count), FLEXITIMER_OK);
+    c_fired.clear();
+
+    for(int step = 0; step < 5000; step++)
+    {
+        timer_id_t id = random() % count;
+        timer_time_t value = random() % 20;
+
+        switch(random() % 10)
+        {
+            case 0:
+            {
+                timer_type_t type = (random() % 2) ? TIMER_TYPE_PERIODIC : TIMER_TYPE_SINGLESHOT;
+                ASSERT_EQ(scheduler.start(id, type, value), flexitimer_ctx_start(&ctx, id, type, value, record_callback));
+                break;
+            }
+            case 1:
+                ASSERT_EQ(scheduler.delay(id, value), flexitimer_ctx_delay(&ctx, id, value));
+                break;
+            case 2:
+                ASSERT_EQ(scheduler.pause(id), flexitimer_ctx_pause(&ctx, id));
+                break;
+            case 3:
+                ASSERT_EQ(scheduler.resume(id), flexitimer_ctx_resume(&ctx, id));
+                break;
+            case 4:
+                ASSERT_EQ(scheduler.restart(id), flexitimer_ctx_restart(&ctx, id));
+                break;
+            case 5:
+                ASSERT_EQ(scheduler.cancel(id), flexitimer_ctx_cancel(&ctx, id));
+                break;
+            case 6:
+                scheduler.advance(value);
+                flexitimer_ctx_advance(&ctx, value);
+                break;
+            default:
+                scheduler.handler();
+                flexitimer_ctx_handler(&ctx);
+                break;
+        }
+
+        ASSERT_EQ(fired, c_fired) << "step " << step;
+
+        for(timer_id_t i = 0; i < count; i++)
+        {
+            timer_state_t cpp_state, c_state;
+            timer_time_t cpp_elapsed, c_elapsed;
+            (void)scheduler.get_state(i, &cpp_state);
+            (void)flexitimer_ctx_get_state(&ctx, i, &c_state);
+            (void)scheduler.get_elapsed(i, &cpp_elapsed);
+            (void)flexitimer_ctx_get_elapsed(&ctx, i, &c_elapsed);
+            ASSERT_EQ(cpp_state, c_state) << "step " << step << " timer " << (int)i;
+            ASSERT_EQ(cpp_elapsed, c_elapsed) << "step " << step << " timer " << (int)i;
+        }
+    }
+}
@@ -1,12 +1,158 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
 #include "flexitimer.h"
+#include "flexitimer_static.h"
+#if defined(__unix__)
+#include "flexitimer_workers.h"
+#endif
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "flexitimer_linux.h"
+#include "flexitimer_shards.h"
+#endif
 
 extern "C" {
     static int callback_count = 0;
+    static std::vector<timer_id_t> callback_order;
     void test_callback(timer_id_t id)
     {
         callback_count++;
     }
+    void order_callback(timer_id_t id)
+    {
+        callback_order.push_back(id);
+    }
+    void cancel_next_callback(timer_id_t id)
+    {
+        callback_count++;
+        flexitimer_cancel(id + 1);
+    }
+#if defined(__linux__)
+    static flexitimer_linux_t *running_driver = NULL;
+    void stop_driver_callback(timer_id_t id)
+    {
+        callback_count++;
+        flexitimer_linux_stop(running_driver);
+    }
+#endif
+    static std::atomic<int> deferred_runs(0);
+    static std::atomic<int> deferred_inside(0);
+    static std::atomic<int> deferred_overlaps(0);
+    static std::atomic<bool> deferred_release(false);
+    void blocking_callback(timer_id_t id)
+    {
+        while(!deferred_release)
+        {
+            std::this_thread::yield();
+        }
+
+        deferred_runs++;
+    }
+    void exclusive_callback(timer_id_t id)
+    {
+        if(deferred_inside++ != 0)
+        {
+            deferred_overlaps++;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        deferred_runs++;
+        deferred_inside--;
+    }
+#if defined(__linux__) && (FLEXITIMER_QUEUE_SIZE > 0)
+    static flexitimer_shards_t *test_shards = NULL;
+    static std::atomic<int> shard_runs[4];
+    static std::atomic<int> shard_inside[16];
+    static std::atomic<int> shard_violations(0);
+    void shard_callback(timer_id_t id)
+    {
+        uint32_t key = flexitimer_shards_callback_key(test_shards, id);
+
+        if(shard_inside[key % 16]++ != 0)
+        {
+            shard_violations++; // overlaps itself
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        shard_inside[key % 16]--;
+        shard_runs[key % 4]++;
+    }
+    void lockstep_callback(timer_id_t id)
+    {
+        uint32_t shard = flexitimer_shards_callback_key(test_shards, id) % 4;
+        int round = ++shard_runs[shard];
+
+        for(int i = 0; i < 4; i++)
+        {
+            if(shard_runs[i] < round - 1)
+            {
+                shard_violations++; // another shard is still behind by a full tick
+            }
+        }
+    }
+#endif
+    static timer_time_t source_now = 0;
+    timer_time_t test_time_source(void)
+    {
+        return source_now;
+    }
+}
+
+FLEXITIMER_STATIC_TABLE(phased_table,
+                        FLEXITIMER_STATIC_TIMER(0, TIMER_TYPE_PERIODIC, 4, 2, order_callback),
+                        FLEXITIMER_STATIC_TIMER(1, TIMER_TYPE_PERIODIC, 4, 0, order_callback),
+                        FLEXITIMER_STATIC_TIMER(7, TIMER_TYPE_SINGLESHOT, 3, 0, order_callback));
+
+FLEXITIMER_STATIC_TABLE(control_table,
+                        FLEXITIMER_STATIC_TIMER(0, TIMER_TYPE_PERIODIC, 5, 3, test_callback),
+                        FLEXITIMER_STATIC_TIMER(1, TIMER_TYPE_PERIODIC, 7, 0, test_callback));
+
+FLEXITIMER_STATIC_TABLE(advance_table,
+                        FLEXITIMER_STATIC_TIMER(0, TIMER_TYPE_PERIODIC, 6, 1, order_callback),
+                        FLEXITIMER_STATIC_TIMER(1, TIMER_TYPE_PERIODIC, 9, 4, order_callback),
+                        FLEXITIMER_STATIC_TIMER(2, TIMER_TYPE_SINGLESHOT, 20, 0, order_callback));
+
+#if FLEXITIMER_CALLBACK_TABLE
+#if FLEXITIMER_STATS
+extern "C" void slow_callback(timer_id_t id);
+#endif
+#if FLEXITIMER_PRIORITIES
+extern "C" void costly_callback(timer_id_t id);
+#endif
+static const timer_callback_t test_callbacks[] =
+{
+    test_callback, order_callback, cancel_next_callback, blocking_callback, exclusive_callback,
+#if defined(__linux__)
+    stop_driver_callback,
+#endif
+#if defined(__linux__) && (FLEXITIMER_QUEUE_SIZE > 0)
+    shard_callback, lockstep_callback,
+#endif
+#if FLEXITIMER_STATS
+    slow_callback,
+#endif
+#if FLEXITIMER_PRIORITIES
+    costly_callback,
+#endif
+};
+#endif
+
+/* Registers the test callbacks with a context whose timers store callback table indexes, NULL for the default one */
+static void use_test_callbacks(flexitimer_ctx_t *ctx)
+{
+#if FLEXITIMER_CALLBACK_TABLE
+    uint32_t count = sizeof(test_callbacks) / sizeof(test_callbacks[0]);
+    ASSERT_EQ((ctx != NULL) ? flexitimer_ctx_set_callbacks(ctx, test_callbacks, count) : flexitimer_set_callbacks(test_callbacks, count), FLEXITIMER_OK);
+#else
+    (void)ctx;
+#endif
 }
 
 class FlexiTimerTest : public ::testing::Test
@@ -15,7 +161,9 @@ protected:
     void SetUp() override
     {
         flexitimer_init();
+        use_test_callbacks(NULL);
         callback_count = 0;
+        callback_order.clear();
     }
 };
 
@@ -152,4 +300,1733 @@ TEST_F(FlexiTimerTest, RestartPassiveSingleShotTimer)
 
     flexitimer_handler(); // Should trigger callback again
     EXPECT_EQ(callback_count, 2);
-}
\ No newline at end of file
+}
+
+TEST_F(FlexiTimerTest, LongTimeoutExpiresOnTime)
+{
+    timer_time_t remaining;
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 5000, test_callback);
+
+    for(int i = 0; i < 4999; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(callback_count, 0);
+    flexitimer_get_elapsed(0, &remaining);
+    EXPECT_EQ(remaining, 1);
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+}
+
+TEST_F(FlexiTimerTest, PeriodicTimerStaysOnPeriod)
+{
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 100, test_callback);
+    flexitimer_start(1, TIMER_TYPE_PERIODIC, 7, nullptr);
+
+    for(int i = 0; i < 10000; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(callback_count, 100);
+    timer_time_t remaining;
+    flexitimer_get_elapsed(0, &remaining);
+    EXPECT_EQ(remaining, 100);
+}
+
+TEST_F(FlexiTimerTest, SameTickCallbacksInIdOrder)
+{
+    flexitimer_start(3, TIMER_TYPE_SINGLESHOT, 70, order_callback);
+    flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 70, order_callback);
+    flexitimer_start(2, TIMER_TYPE_SINGLESHOT, 70, order_callback);
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 69, order_callback);
+
+    for(int i = 0; i < 70; i++)
+    {
+        flexitimer_handler();
+    }
+
+    std::vector<timer_id_t> expected = {0, 1, 2, 3};
+    EXPECT_EQ(callback_order, expected);
+}
+
+TEST_F(FlexiTimerTest, PausedTimerKeepsRemaining)
+{
+    timer_time_t remaining;
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 10, test_callback);
+    flexitimer_handler();
+    flexitimer_handler();
+    flexitimer_handler();
+    flexitimer_pause(0);
+
+    for(int i = 0; i < 100; i++)
+    {
+        flexitimer_handler();
+    }
+
+    flexitimer_get_elapsed(0, &remaining);
+    EXPECT_EQ(remaining, 7);
+    flexitimer_resume(0);
+
+    for(int i = 0; i < 6; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(callback_count, 0);
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+}
+
+TEST_F(FlexiTimerTest, DelayPostponesExpiry)
+{
+    timer_time_t remaining;
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 5, test_callback);
+    flexitimer_handler();
+    flexitimer_handler();
+    EXPECT_EQ(flexitimer_delay(0, 100), FLEXITIMER_OK);
+    flexitimer_get_elapsed(0, &remaining);
+    EXPECT_EQ(remaining, 103);
+
+    for(int i = 0; i < 102; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(callback_count, 0);
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+}
+
+TEST_F(FlexiTimerTest, CallbackCancelsTimerDueOnSameTick)
+{
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 3, cancel_next_callback);
+    flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 3, test_callback);
+    flexitimer_handler();
+    flexitimer_handler();
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+    timer_state_t state;
+    flexitimer_get_state(1, &state);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+}
+
+TEST_F(FlexiTimerTest, NextExpiryWithoutActiveTimers)
+{
+    timer_time_t ticks;
+    EXPECT_EQ(flexitimer_next_expiry(nullptr), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_ERROR_INVALID_STATE);
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 5, nullptr);
+    flexitimer_pause(0);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_ERROR_INVALID_STATE);
+}
+
+TEST_F(FlexiTimerTest, NextExpiryReportsEarliestTimer)
+{
+    timer_time_t ticks;
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 5000, nullptr);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 5000);
+    flexitimer_start(1, TIMER_TYPE_PERIODIC, 70, nullptr);
+    flexitimer_start(2, TIMER_TYPE_SINGLESHOT, 300, nullptr);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 70);
+
+    for(int i = 0; i < 70; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 70);
+    flexitimer_cancel(1);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 230);
+    flexitimer_cancel(2);
+
+    for(int i = 0; i < 4000; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 930);
+}
+
+TEST_F(FlexiTimerTest, NextExpiryOfZeroTimeoutIsNextTick)
+{
+    timer_time_t ticks;
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 0, nullptr);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 1);
+}
+
+TEST_F(FlexiTimerTest, AdvanceMatchesRepeatedHandlerCalls)
+{
+    std::vector<timer_id_t> expected;
+    std::vector<timer_time_t> remaining(3), advanced(3);
+
+    for(int pass = 0; pass < 2; pass++)
+    {
+        flexitimer_init();
+        use_test_callbacks(NULL);
+        callback_order.clear();
+        flexitimer_start(0, TIMER_TYPE_PERIODIC, 7, order_callback);
+        flexitimer_start(1, TIMER_TYPE_PERIODIC, 2, order_callback);
+        flexitimer_start(2, TIMER_TYPE_SINGLESHOT, 150, order_callback);
+        flexitimer_start(3, TIMER_TYPE_SINGLESHOT, 9000, order_callback);
+
+        if(pass == 0)
+        {
+            for(int i = 0; i < 5000; i++)
+            {
+                flexitimer_handler();
+            }
+
+            expected = callback_order;
+        }
+        else
+        {
+            flexitimer_advance(5000);
+        }
+
+        for(timer_id_t id = 0; id < 3; id++)
+        {
+            flexitimer_get_elapsed(id, pass == 0 ? &remaining[id] : &advanced[id]);
+        }
+    }
+
+    EXPECT_EQ(callback_order.size(), 714u + 2500u + 1u);
+    EXPECT_EQ(callback_order, expected);
+    EXPECT_EQ(advanced, remaining);
+    timer_time_t ticks;
+    flexitimer_cancel(0);
+    flexitimer_cancel(1);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 4000);
+}
+
+TEST_F(FlexiTimerTest, AdvanceWithoutTimersKeepsTime)
+{
+    flexitimer_advance(0);
+    flexitimer_advance(100000);
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 3, test_callback);
+    flexitimer_advance(2);
+    EXPECT_EQ(callback_count, 0);
+    flexitimer_advance(1);
+    EXPECT_EQ(callback_count, 1);
+}
+
+#if FLEXITIMER_COUNTER_BITS == 32
+TEST_F(FlexiTimerTest, AdvanceOverLongIdleSpans)
+{
+    timer_time_t now;
+
+    flexitimer_advance(3000000000u);
+    ASSERT_EQ(flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 2000000000u, test_callback), FLEXITIMER_OK); // expires after the tick count wraps
+    ASSERT_EQ(flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 70000u, test_callback), FLEXITIMER_OK);
+    flexitimer_advance(69999u);
+    EXPECT_EQ(callback_count, 0);
+    flexitimer_advance(1u);
+    EXPECT_EQ(callback_count, 1);
+    flexitimer_advance(2000000000u - 70001u);
+    EXPECT_EQ(callback_count, 1);
+    flexitimer_advance(1u);
+    EXPECT_EQ(callback_count, 2);
+    ASSERT_EQ(flexitimer_get_now(&now), FLEXITIMER_OK);
+    EXPECT_EQ(now, 3000000000u + 2000000000u);
+}
+#endif
+
+TEST_F(FlexiTimerTest, ContextInitRejectsInvalidArguments)
+{
+    flexitimer_ctx_t ctx;
+    flexitimer_timer_t storage[4];
+    EXPECT_EQ(flexitimer_ctx_init(nullptr, storage, 4), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_ctx_init(&ctx, nullptr, 4), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_ctx_init(&ctx, storage, 0), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_ctx_init(&ctx, storage, 4), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_ctx_start(&ctx, 4, TIMER_TYPE_SINGLESHOT, 1, test_callback), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_ctx_start(nullptr, 0, TIMER_TYPE_SINGLESHOT, 1, test_callback), FLEXITIMER_ERROR_INVALID_ARG);
+}
+
+TEST_F(FlexiTimerTest, ContextsAreIndependent)
+{
+    flexitimer_ctx_t first, second;
+    flexitimer_timer_t first_storage[2], second_storage[200];
+    uint32_t second_capacity = sizeof(second_storage) / sizeof(second_storage[0]);
+    timer_time_t remaining;
+    timer_state_t state;
+
+    ASSERT_EQ(flexitimer_ctx_init(&first, first_storage, 2), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_ctx_init(&second, second_storage, second_capacity), FLEXITIMER_OK);
+    use_test_callbacks(&first);
+    use_test_callbacks(&second);
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 50, test_callback);
+    flexitimer_ctx_start(&first, 0, TIMER_TYPE_PERIODIC, 2, order_callback);
+    flexitimer_ctx_start(&second, (timer_id_t)(second_capacity - 1), TIMER_TYPE_SINGLESHOT, 3, order_callback);
+
+    flexitimer_ctx_handler(&first);
+    flexitimer_ctx_handler(&first);
+    flexitimer_ctx_advance(&second, 3);
+    std::vector<timer_id_t> expected = {0, (timer_id_t)(second_capacity - 1)};
+    EXPECT_EQ(callback_order, expected);
+    EXPECT_EQ(callback_count, 0);
+
+    flexitimer_get_elapsed(0, &remaining);
+    EXPECT_EQ(remaining, 50);
+    flexitimer_ctx_get_elapsed(&first, 0, &remaining);
+    EXPECT_EQ(remaining, 2);
+    flexitimer_ctx_get_state(&second, (timer_id_t)(second_capacity - 1), &state);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+    EXPECT_EQ(flexitimer_ctx_cancel(&first, 1), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_ctx_cancel(&first, 2), FLEXITIMER_ERROR_INVALID_ID);
+}
+
+TEST_F(FlexiTimerTest, SparseTimersOfLargeContext)
+{
+    flexitimer_ctx_t ctx;
+    flexitimer_timer_t storage[200];
+    timer_time_t ticks;
+
+    ASSERT_EQ(flexitimer_ctx_init(&ctx, storage, 200), FLEXITIMER_OK);
+    use_test_callbacks(&ctx);
+    flexitimer_ctx_start(&ctx, 199, TIMER_TYPE_SINGLESHOT, 3, order_callback);
+    flexitimer_ctx_start(&ctx, 130, TIMER_TYPE_PERIODIC, 2, order_callback);
+    flexitimer_ctx_start(&ctx, 131, TIMER_TYPE_SINGLESHOT, 1, order_callback);
+    flexitimer_ctx_start(&ctx, 5, TIMER_TYPE_SINGLESHOT, 3, order_callback);
+    flexitimer_ctx_cancel(&ctx, 131);
+
+    for(int i = 0; i < 4; i++)
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    std::vector<timer_id_t> expected = {130, 5, 199, 130};
+    EXPECT_EQ(callback_order, expected);
+    flexitimer_ctx_cancel(&ctx, 130);
+    EXPECT_EQ(flexitimer_ctx_next_expiry(&ctx, &ticks), FLEXITIMER_ERROR_INVALID_STATE);
+}
+
+TEST_F(FlexiTimerTest, PollFollowsTimeSource)
+{
+    source_now = 1000;
+    flexitimer_set_time_source(test_time_source);
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 10, order_callback);
+
+    /* Irregular polls, the timer stays on its 10 tick grid */
+    const timer_time_t polls[] = {3, 9, 10, 27, 28, 41, 60};
+    std::vector<size_t> fired;
+
+    for(timer_time_t t : polls)
+    {
+        source_now = 1000 + t;
+        flexitimer_poll();
+        fired.push_back(callback_order.size());
+    }
+
+    std::vector<size_t> expected = {0, 0, 1, 2, 2, 4, 6};
+    EXPECT_EQ(fired, expected);
+
+    timer_time_t remaining;
+    flexitimer_get_elapsed(0, &remaining);
+    EXPECT_EQ(remaining, 10);
+}
+
+TEST_F(FlexiTimerTest, CatchupPolicies)
+{
+    timer_time_t remaining;
+
+    EXPECT_EQ(flexitimer_set_catchup(1, FLEXITIMER_CATCHUP_COALESCE), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_set_catchup(2, FLEXITIMER_CATCHUP_SKIP), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_set_catchup(3, FLEXITIMER_CATCHUP_SKIP), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_set_catchup(FLEXITIMER_MAX_TIMERS, FLEXITIMER_CATCHUP_SKIP), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_set_catchup(0, (flexitimer_catchup_t)7), FLEXITIMER_ERROR_INVALID_ARG);
+
+    for(timer_id_t id = 0; id < 3; id++)
+    {
+        flexitimer_start(id, TIMER_TYPE_PERIODIC, 10, order_callback);
+    }
+
+    flexitimer_start(3, TIMER_TYPE_PERIODIC, 5, order_callback);
+
+    /* Deadlines 10, 20 and 30 are late, 35 is on time for timer 3 */
+    flexitimer_advance(35);
+    std::vector<timer_id_t> expected = {0, 1, 0, 0, 3};
+    EXPECT_EQ(callback_order, expected);
+
+    for(timer_id_t id = 0; id < 3; id++)
+    {
+        flexitimer_get_elapsed(id, &remaining);
+        EXPECT_EQ(remaining, 5); // back on the grid at 40
+    }
+
+    callback_order.clear();
+    flexitimer_advance(5);
+    expected = {0, 1, 2, 3};
+    EXPECT_EQ(callback_order, expected);
+}
+
+#if FLEXITIMER_SLACK
+TEST_F(FlexiTimerTest, SlackCoalescesWakeups)
+{
+    for(timer_id_t id = 0; id < 8; id++)
+    {
+        EXPECT_EQ(flexitimer_start_ex(id, TIMER_TYPE_SINGLESHOT, 50 + id, 20, order_callback), FLEXITIMER_OK);
+    }
+
+    /* All windows overlap, one wakeup serves them all */
+    timer_time_t next;
+    ASSERT_EQ(flexitimer_next_expiry(&next), FLEXITIMER_OK);
+    EXPECT_GE(next, 57);
+    EXPECT_LE(next, 70);
+    flexitimer_advance(next);
+    EXPECT_EQ(callback_order.size(), 8u);
+    EXPECT_EQ(flexitimer_next_expiry(&next), FLEXITIMER_ERROR_INVALID_STATE);
+
+    EXPECT_EQ(flexitimer_start_ex(0, TIMER_TYPE_PERIODIC, 10, 10, order_callback), FLEXITIMER_ERROR_INVALID_ARG);
+}
+
+TEST_F(FlexiTimerTest, SlackKeepsPeriodicGrid)
+{
+    flexitimer_start_ex(0, TIMER_TYPE_PERIODIC, 10, 3, order_callback);
+    std::vector<timer_time_t> fired;
+
+    for(timer_time_t tick = 1; tick <= 1003; tick++)
+    {
+        flexitimer_handler();
+
+        if(!callback_order.empty())
+        {
+            fired.push_back(tick);
+            callback_order.clear();
+        }
+    }
+
+    ASSERT_EQ(fired.size(), 100u);
+
+    for(size_t k = 0; k < fired.size(); k++)
+    {
+        EXPECT_GE(fired[k], (k + 1) * 10);
+        EXPECT_LE(fired[k], (k + 1) * 10 + 3);
+    }
+}
+#endif
+
+TEST_F(FlexiTimerTest, BulkOperations)
+{
+    const timer_id_t ids[] = {1, 3, 5};
+    const timer_id_t mixed[] = {1, 2, 3};
+    const timer_id_t invalid[] = {0, FLEXITIMER_MAX_TIMERS};
+    timer_state_t states[FLEXITIMER_MAX_TIMERS];
+    timer_time_t remaining[FLEXITIMER_MAX_TIMERS];
+
+    EXPECT_EQ(flexitimer_start_many(invalid, 2, TIMER_TYPE_SINGLESHOT, 4, test_callback), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_start_many(ids, 3, TIMER_TYPE_PERIODIC, 0, test_callback), FLEXITIMER_ERROR_ZERO_TIMEOUT);
+    EXPECT_EQ(flexitimer_cancel_many(NULL, FLEXITIMER_MAX_TIMERS + 1), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_start_many(ids, 0, TIMER_TYPE_SINGLESHOT, 4, test_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_query_many(NULL, FLEXITIMER_MAX_TIMERS, states, NULL), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < FLEXITIMER_MAX_TIMERS; id++)
+    {
+        EXPECT_EQ(states[id], TIMER_STATE_PASSIVE); // nothing started by the failed calls
+    }
+
+    ASSERT_EQ(flexitimer_start_many(ids, 3, TIMER_TYPE_SINGLESHOT, 4, test_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_pause(5), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_delay_many(mixed, 3, 2), FLEXITIMER_ERROR_INVALID_STATE); // 2 is passive, 1 and 3 are delayed
+    EXPECT_EQ(flexitimer_delay_many(&ids[2], 1, 1), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_delay_many(ids, 3, UINT32_MAX), FLEXITIMER_ERROR_INVALID_ARG);
+    const timer_id_t repeated[] = {3, 1, 3};
+    EXPECT_EQ(flexitimer_delay_many(repeated, 3, FLEXITIMER_COUNTER_MAX - 6u), FLEXITIMER_ERROR_INVALID_ARG); // 3 twice does not fit, nothing delayed
+    ASSERT_EQ(flexitimer_query_many(ids, 3, states, remaining), FLEXITIMER_OK);
+    EXPECT_EQ(states[0], TIMER_STATE_ACTIVE);
+    EXPECT_EQ(states[2], TIMER_STATE_PAUSED);
+    EXPECT_EQ(remaining[0], 6u);
+    EXPECT_EQ(remaining[1], 6u);
+    EXPECT_EQ(remaining[2], 5u);
+
+    flexitimer_advance(6);
+    EXPECT_EQ(callback_count, 2);
+    ASSERT_EQ(flexitimer_cancel_many(NULL, FLEXITIMER_MAX_TIMERS), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_query_many(NULL, FLEXITIMER_MAX_TIMERS, states, remaining), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < FLEXITIMER_MAX_TIMERS; id++)
+    {
+        EXPECT_EQ(states[id], TIMER_STATE_PASSIVE);
+        EXPECT_EQ(remaining[id], 0u);
+    }
+}
+
+TEST_F(FlexiTimerTest, BulkOperationsMatchSingleCalls)
+{
+    const uint32_t count = 64;
+    flexitimer_ctx_t bulk, single;
+    flexitimer_timer_t bulk_storage[count], single_storage[count];
+    std::mt19937 random(3);
+
+    ASSERT_EQ(flexitimer_ctx_init(&bulk, bulk_storage, count), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_ctx_init(&single, single_storage, count), FLEXITIMER_OK);
+    use_test_callbacks(&bulk);
+    use_test_callbacks(&single);
+
+    for(int step = 0; step < 400; step++)
+    {
+        std::vector<timer_id_t> ids(random() % count);
+        timer_time_t value = 1u + (random() % 40u);
+
+        for(timer_id_t &id : ids)
+        {
+            id = (timer_id_t)(random() % count); // repeated ids included
+        }
+
+        switch(random() % 4)
+        {
+            case 0:
+                ASSERT_EQ(flexitimer_ctx_start_many(&bulk, ids.data(), (uint32_t)ids.size(), TIMER_TYPE_PERIODIC, value, order_callback), FLEXITIMER_OK);
+
+                for(timer_id_t id : ids)
+                {
+                    (void)flexitimer_ctx_start(&single, id, TIMER_TYPE_PERIODIC, value, order_callback);
+                }
+
+                break;
+
+            case 1:
+                ASSERT_EQ(flexitimer_ctx_cancel_many(&bulk, ids.data(), (uint32_t)ids.size()), FLEXITIMER_OK);
+
+                for(timer_id_t id : ids)
+                {
+                    (void)flexitimer_ctx_cancel(&single, id);
+                }
+
+                break;
+
+            case 2:
+                (void)flexitimer_ctx_delay_many(&bulk, ids.data(), (uint32_t)ids.size(), value);
+
+                for(timer_id_t id : ids)
+                {
+                    (void)flexitimer_ctx_delay(&single, id, value);
+                }
+
+                break;
+
+            default:
+                callback_order.clear();
+                flexitimer_ctx_advance(&bulk, value);
+                std::vector<timer_id_t> bulk_order = callback_order;
+                callback_order.clear();
+                flexitimer_ctx_advance(&single, value);
+                ASSERT_EQ(bulk_order, callback_order) << "step " << step;
+                break;
+        }
+
+        timer_state_t bulk_states[count], single_states[count];
+        timer_time_t bulk_remaining[count], single_remaining[count];
+        ASSERT_EQ(flexitimer_ctx_query_many(&bulk, NULL, count, bulk_states, bulk_remaining), FLEXITIMER_OK);
+
+        for(timer_id_t id = 0; id < count; id++)
+        {
+            (void)flexitimer_ctx_get_state(&single, id, &single_states[id]);
+            (void)flexitimer_ctx_get_elapsed(&single, id, &single_remaining[id]);
+            ASSERT_EQ(bulk_states[id], single_states[id]) << "step " << step << " timer " << (int)id;
+            ASSERT_EQ(bulk_remaining[id], single_remaining[id]) << "step " << step << " timer " << (int)id;
+        }
+    }
+}
+
+#if FLEXITIMER_COUNTER_BITS < 32
+TEST_F(FlexiTimerTest, NarrowCountersBoundTimeouts)
+{
+    timer_time_t remaining;
+    EXPECT_EQ(flexitimer_start(0, TIMER_TYPE_SINGLESHOT, FLEXITIMER_COUNTER_MAX + 1u, test_callback), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_start_ex(0, TIMER_TYPE_SINGLESHOT, FLEXITIMER_COUNTER_MAX, 1, test_callback), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_start(0, TIMER_TYPE_SINGLESHOT, FLEXITIMER_COUNTER_MAX - 5u, test_callback), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_delay(0, 6), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_delay(0, 5), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_pause(0), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_delay(0, 1), FLEXITIMER_ERROR_INVALID_ARG);
+
+    /* A coalesced catch-up longer than the counters fires once per counter range */
+    EXPECT_EQ(flexitimer_set_catchup(1, FLEXITIMER_CATCHUP_COALESCE), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_start(1, TIMER_TYPE_PERIODIC, 100, test_callback), FLEXITIMER_OK);
+    flexitimer_advance(100u * (FLEXITIMER_COUNTER_MAX / 100u) * 3u);
+    EXPECT_EQ(callback_count, 3);
+    flexitimer_get_elapsed(1, &remaining);
+    EXPECT_EQ(remaining, 100);
+}
+#endif
+
+#if FLEXITIMER_CALLBACK_TABLE
+TEST_F(FlexiTimerTest, CallbackTableStoresIndexes)
+{
+    EXPECT_EQ(flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 1, order_callback), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_set_callbacks(test_callbacks, 1), FLEXITIMER_OK); // test_callback only
+    EXPECT_EQ(flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 1, order_callback), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_start(2, TIMER_TYPE_SINGLESHOT, 1, NULL), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_set_callbacks(NULL, 1), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_set_callbacks(test_callbacks, 256), FLEXITIMER_ERROR_INVALID_ARG);
+    use_test_callbacks(NULL);
+
+    flexitimer_handler();
+    std::vector<timer_id_t> expected = {0};
+    EXPECT_EQ(callback_order, expected);
+    EXPECT_EQ(flexitimer_restart(2), FLEXITIMER_ERROR_INVALID_STATE); // no callback, as with NULL pointers
+}
+#endif
+
+#if defined(__unix__)
+TEST_F(FlexiTimerTest, DeferredCallbackDoesNotBlockHandler)
+{
+    static flexitimer_worker_slot_t slots[FLEXITIMER_MAX_TIMERS];
+    flexitimer_workers_t workers;
+    EXPECT_EQ(flexitimer_workers_init(&workers, NULL, slots, 0), FLEXITIMER_ERROR_INVALID_ARG);
+    ASSERT_EQ(flexitimer_workers_init(&workers, NULL, slots, 2), FLEXITIMER_OK);
+    deferred_runs = 0;
+    deferred_release = false;
+
+    EXPECT_EQ(flexitimer_set_dispatch(0, FLEXITIMER_DISPATCH_DEFERRED), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_set_dispatch(0, (flexitimer_dispatch_t)2), FLEXITIMER_ERROR_INVALID_ARG);
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 1, blocking_callback);
+    flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 1, test_callback);
+
+    /* Timer 0 blocks on a worker, timer 1 still runs inline on time */
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+    EXPECT_EQ(deferred_runs, 0);
+
+    deferred_release = true;
+    flexitimer_workers_deinit(&workers);
+    EXPECT_EQ(deferred_runs, 1);
+}
+
+TEST_F(FlexiTimerTest, DeferredPeriodicNeverOverlapsItself)
+{
+    static flexitimer_worker_slot_t slots[FLEXITIMER_MAX_TIMERS];
+    flexitimer_workers_t workers;
+    ASSERT_EQ(flexitimer_workers_init(&workers, NULL, slots, 4), FLEXITIMER_OK);
+    deferred_runs = 0;
+    deferred_overlaps = 0;
+
+    flexitimer_set_dispatch(0, FLEXITIMER_DISPATCH_DEFERRED);
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 1, exclusive_callback);
+
+    for(int i = 0; i < 100; i++)
+    {
+        flexitimer_handler();
+    }
+
+    flexitimer_advance(50);
+    flexitimer_workers_deinit(&workers);
+    EXPECT_EQ(deferred_runs, 150);
+    EXPECT_EQ(deferred_overlaps, 0);
+}
+#endif
+
+#if defined(__linux__)
+TEST_F(FlexiTimerTest, LinuxDriverRunsUntilStopped)
+{
+    flexitimer_linux_t driver;
+    ASSERT_EQ(flexitimer_linux_init(&driver, NULL, 1000000), FLEXITIMER_OK);
+    running_driver = &driver;
+
+    auto begin = std::chrono::steady_clock::now();
+    flexitimer_start(0, TIMER_TYPE_SINGLESHOT, 5, stop_driver_callback);
+    flexitimer_linux_rearm(&driver);
+    EXPECT_EQ(flexitimer_linux_run(&driver), FLEXITIMER_OK);
+
+    EXPECT_EQ(callback_count, 1);
+    EXPECT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(5));
+    flexitimer_linux_deinit(&driver);
+    EXPECT_EQ(flexitimer_linux_fd(&driver), -1);
+}
+
+TEST_F(FlexiTimerTest, LinuxDriverFdWakesEpollOnlyWhenDue)
+{
+    flexitimer_linux_t driver;
+    ASSERT_EQ(flexitimer_linux_init(&driver, NULL, 1000000), FLEXITIMER_OK);
+
+    int epfd = epoll_create1(0);
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    ASSERT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, flexitimer_linux_fd(&driver), &event), 0);
+
+    /* Nothing armed, no wakeup */
+    EXPECT_EQ(epoll_wait(epfd, &event, 1, 20), 0);
+
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 3, test_callback);
+    flexitimer_linux_rearm(&driver);
+
+    while(callback_count < 3)
+    {
+        ASSERT_EQ(epoll_wait(epfd, &event, 1, 1000), 1);
+        EXPECT_EQ(flexitimer_linux_dispatch(&driver), FLEXITIMER_OK);
+    }
+
+    flexitimer_cancel(0);
+    flexitimer_linux_rearm(&driver);
+    EXPECT_EQ(epoll_wait(epfd, &event, 1, 20), 0);
+
+    /* A wakeup from another thread makes the descriptor readable */
+    std::thread([&driver] { flexitimer_linux_wakeup(&driver); }).join();
+    EXPECT_EQ(epoll_wait(epfd, &event, 1, 1000), 1);
+    EXPECT_EQ(flexitimer_linux_dispatch(&driver), FLEXITIMER_OK);
+    EXPECT_EQ(epoll_wait(epfd, &event, 1, 20), 0);
+
+    close(epfd);
+    flexitimer_linux_deinit(&driver);
+}
+
+#if FLEXITIMER_QUEUE_SIZE > 0
+static flexitimer_shard_t test_shard_storage[4];
+static flexitimer_timer_t test_shard_timers[4 * 8];
+
+TEST_F(FlexiTimerTest, ShardsStealCallbacksWithoutOverlap)
+{
+    flexitimer_shards_t sharded;
+    flexitimer_shards_config_t config = {1000000, 100000, FLEXITIMER_SHARDS_FREE, -1};
+    test_shards = &sharded;
+    shard_violations = 0;
+
+    for(auto &runs : shard_runs)
+    {
+        runs = 0;
+    }
+
+    EXPECT_EQ(flexitimer_shards_init(&sharded, test_shard_storage, 0, test_shard_timers, 8, &config), FLEXITIMER_ERROR_INVALID_ARG);
+    ASSERT_EQ(flexitimer_shards_init(&sharded, test_shard_storage, 4, test_shard_timers, 8, &config), FLEXITIMER_OK);
+
+    for(int i = 0; i < 4; i++)
+    {
+        use_test_callbacks(&test_shard_storage[i].ctx);
+    }
+    EXPECT_LT(flexitimer_shards_local(&sharded), 4u);
+    EXPECT_EQ(flexitimer_shards_start(&sharded, flexitimer_shards_key(&sharded, 0, 8), TIMER_TYPE_SINGLESHOT, 1, shard_callback), FLEXITIMER_ERROR_INVALID_ID);
+
+    /* Slow periodic callbacks, all on shard 0, the idle shards help out */
+    for(timer_id_t id = 0; id < 4; id++)
+    {
+        EXPECT_EQ(flexitimer_shards_start(&sharded, flexitimer_shards_key(&sharded, 0, id), TIMER_TYPE_PERIODIC, 4, shard_callback), FLEXITIMER_OK);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    uint64_t stolen = 0;
+
+    for(uint32_t shard = 0; shard < 4; shard++)
+    {
+        stolen += flexitimer_shards_stolen(&sharded, shard);
+    }
+
+    for(timer_id_t id = 0; id < 4; id++)
+    {
+        flexitimer_shards_cancel(&sharded, flexitimer_shards_key(&sharded, 0, id));
+    }
+
+    flexitimer_shards_deinit(&sharded);
+
+    EXPECT_GT(shard_runs[0], 0);
+    EXPECT_EQ(shard_runs[1] + shard_runs[2] + shard_runs[3], 0);
+    EXPECT_EQ(shard_violations, 0);
+    EXPECT_GT(stolen, 0u);
+}
+
+TEST_F(FlexiTimerTest, ShardsLockstepOrdersTicks)
+{
+    flexitimer_shards_t sharded;
+    flexitimer_shards_config_t config = {1000000, 100000, FLEXITIMER_SHARDS_LOCKSTEP, -1};
+    test_shards = &sharded;
+    shard_violations = 0;
+
+    for(auto &runs : shard_runs)
+    {
+        runs = 0;
+    }
+
+    ASSERT_EQ(flexitimer_shards_init(&sharded, test_shard_storage, 4, test_shard_timers, 8, &config), FLEXITIMER_OK);
+
+    for(int i = 0; i < 4; i++)
+    {
+        use_test_callbacks(&test_shard_storage[i].ctx);
+    }
+
+    for(uint32_t shard = 0; shard < 4; shard++)
+    {
+        flexitimer_shards_start(&sharded, flexitimer_shards_key(&sharded, shard, 0), TIMER_TYPE_PERIODIC, 1, lockstep_callback);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    flexitimer_shards_deinit(&sharded);
+
+    EXPECT_GT(shard_runs[0], 5);
+    EXPECT_LE(abs(shard_runs[0] - shard_runs[3]), 1);
+    EXPECT_EQ(shard_violations, 0);
+}
+#endif
+
+TEST_F(FlexiTimerTest, LinuxTickThreadRunsHandlerAndReportsJitter)
+{
+    flexitimer_linux_tick_t tick;
+    flexitimer_linux_tick_config_t config = {};
+    flexitimer_linux_jitter_t jitter;
+
+    EXPECT_EQ(flexitimer_linux_tick_start(&tick, NULL, &config), FLEXITIMER_ERROR_INVALID_ARG);
+
+    config.tick_ns = 1000000;
+    config.spin_ns = 50000;
+    config.cpu = -1;
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 1, test_callback);
+    ASSERT_EQ(flexitimer_linux_tick_start(&tick, NULL, &config), FLEXITIMER_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    flexitimer_linux_tick_stop(&tick);
+
+    ASSERT_EQ(flexitimer_linux_tick_jitter(&tick, &jitter), FLEXITIMER_OK);
+    EXPECT_GE(jitter.ticks, 10u);
+    EXPECT_EQ(callback_count, (int)(jitter.ticks + jitter.missed));
+    EXPECT_LE(jitter.min_ns, jitter.avg_ns);
+    EXPECT_LE(jitter.avg_ns, jitter.max_ns);
+    EXPECT_LE(jitter.min_ns, jitter.p99_ns);
+    EXPECT_LE(jitter.p99_ns, jitter.max_ns);
+}
+#endif
+
+#if FLEXITIMER_QUEUE_SIZE > 0
+TEST_F(FlexiTimerTest, PostedCommandsApplyOnHandler)
+{
+    timer_state_t state;
+
+    EXPECT_EQ(flexitimer_post_start(0, TIMER_TYPE_SINGLESHOT, 2, test_callback), FLEXITIMER_OK);
+    flexitimer_get_state(0, &state);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+
+    flexitimer_handler();
+    flexitimer_get_state(0, &state);
+    EXPECT_EQ(state, TIMER_STATE_ACTIVE);
+
+    EXPECT_EQ(flexitimer_post_pause(0), FLEXITIMER_OK);
+    flexitimer_handler();
+    flexitimer_get_state(0, &state);
+    EXPECT_EQ(state, TIMER_STATE_PAUSED);
+
+    EXPECT_EQ(flexitimer_post_resume(0), FLEXITIMER_OK);
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+}
+
+TEST_F(FlexiTimerTest, PostValidatesArgumentsAndReportsFullQueue)
+{
+    EXPECT_EQ(flexitimer_post_start(FLEXITIMER_MAX_TIMERS, TIMER_TYPE_SINGLESHOT, 1, test_callback), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_post_start(0, TIMER_TYPE_PERIODIC, 0, test_callback), FLEXITIMER_ERROR_ZERO_TIMEOUT);
+    EXPECT_EQ(flexitimer_ctx_post_cancel(nullptr, 0), FLEXITIMER_ERROR_INVALID_ARG);
+
+    for(int i = 0; i < FLEXITIMER_QUEUE_SIZE; i++)
+    {
+        EXPECT_EQ(flexitimer_post_restart(0), FLEXITIMER_OK);
+    }
+
+    EXPECT_EQ(flexitimer_post_restart(0), FLEXITIMER_ERROR_FULL);
+    flexitimer_handler();
+    EXPECT_EQ(flexitimer_post_restart(0), FLEXITIMER_OK);
+}
+
+TEST_F(FlexiTimerTest, ConcurrentPostsAreAllApplied)
+{
+    const int producers = 4;
+    const int per_producer = 50;
+    flexitimer_ctx_t ctx;
+    flexitimer_timer_t storage[producers * per_producer];
+    std::vector<std::thread> threads;
+
+    ASSERT_EQ(flexitimer_ctx_init(&ctx, storage, producers * per_producer), FLEXITIMER_OK);
+    use_test_callbacks(&ctx);
+
+    for(int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&ctx, p]()
+        {
+            for(int i = 0; i < per_producer; i++)
+            {
+                timer_id_t id = (timer_id_t)(p * per_producer + i);
+
+                while(flexitimer_ctx_post_start(&ctx, id, TIMER_TYPE_SINGLESHOT, 1, order_callback) == FLEXITIMER_ERROR_FULL)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    while(callback_order.size() < (size_t)(producers * per_producer))
+    {
+        flexitimer_ctx_handler(&ctx);
+    }
+
+    for(std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::sort(callback_order.begin(), callback_order.end());
+
+    for(int i = 0; i < producers * per_producer; i++)
+    {
+        EXPECT_EQ(callback_order[i], (timer_id_t)i);
+    }
+}
+#endif
+
+#if FLEXITIMER_GROUPS
+TEST_F(FlexiTimerTest, GroupOperations)
+{
+    flexitimer_group_t groups[2];
+    timer_state_t state;
+    timer_time_t remaining;
+
+    EXPECT_EQ(flexitimer_set_groups(groups, 256), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_ctx_set_groups(NULL, groups, 2), FLEXITIMER_ERROR_INVALID_ARG);
+    ASSERT_EQ(flexitimer_set_groups(groups, 2), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_start_in_group(0, 2, TIMER_TYPE_SINGLESHOT, 5, order_callback), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_group_pause(2), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_ctx_group_cancel(NULL, 0), FLEXITIMER_ERROR_INVALID_ARG);
+
+    ASSERT_EQ(flexitimer_start_in_group(0, 0, TIMER_TYPE_PERIODIC, 5, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(1, 0, TIMER_TYPE_SINGLESHOT, 8, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(2, 0, TIMER_TYPE_SINGLESHOT, 3, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(3, 1, TIMER_TYPE_SINGLESHOT, 4, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(4, TIMER_TYPE_SINGLESHOT, 6, order_callback), FLEXITIMER_OK);
+    flexitimer_advance(2);
+
+    ASSERT_EQ(flexitimer_group_pause(0), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_group_pause(0), FLEXITIMER_ERROR_INVALID_STATE);
+    EXPECT_EQ(flexitimer_pause(0), FLEXITIMER_ERROR_INVALID_STATE); // paused with its group
+    EXPECT_EQ(flexitimer_resume(0), FLEXITIMER_ERROR_INVALID_STATE);
+    flexitimer_advance(10);
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({3, 4}));
+
+    ASSERT_EQ(flexitimer_get_state(1, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PAUSED);
+    ASSERT_EQ(flexitimer_get_elapsed(1, &remaining), FLEXITIMER_OK);
+    EXPECT_EQ(remaining, 6u);
+    ASSERT_EQ(flexitimer_group_delay(0, 2), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_get_elapsed(2, &remaining), FLEXITIMER_OK);
+    EXPECT_EQ(remaining, 3u);
+    ASSERT_EQ(flexitimer_group_resume(0), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_group_resume(0), FLEXITIMER_ERROR_INVALID_STATE);
+    ASSERT_EQ(flexitimer_get_state(1, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_ACTIVE);
+
+    callback_order.clear();
+    flexitimer_advance(3);
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({2}));
+    flexitimer_advance(2);
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({2, 0}));
+    ASSERT_EQ(flexitimer_get_elapsed(1, &remaining), FLEXITIMER_OK);
+    EXPECT_EQ(remaining, 3u);
+
+    ASSERT_EQ(flexitimer_group_cancel(0), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_get_state(0, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+    ASSERT_EQ(flexitimer_get_elapsed(1, &remaining), FLEXITIMER_OK);
+    EXPECT_EQ(remaining, 0u);
+    EXPECT_EQ(flexitimer_restart(1), FLEXITIMER_ERROR_INVALID_STATE); // cancelled like flexitimer_cancel()
+    ASSERT_EQ(flexitimer_start_in_group(5, 0, TIMER_TYPE_SINGLESHOT, 4, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(6, 1, TIMER_TYPE_SINGLESHOT, 4, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(6, TIMER_TYPE_SINGLESHOT, 4, order_callback), FLEXITIMER_OK); // leaves the group
+    ASSERT_EQ(flexitimer_group_pause(1), FLEXITIMER_OK);
+    callback_order.clear();
+    flexitimer_advance(20);
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({5, 6}));
+}
+
+TEST_F(FlexiTimerTest, GroupCancelStopsPeriodicMembers)
+{
+    flexitimer_group_t group;
+    timer_state_t state;
+    timer_time_t ticks;
+
+    ASSERT_EQ(flexitimer_set_groups(&group, 1), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(0, 0, TIMER_TYPE_PERIODIC, 5, test_callback), FLEXITIMER_OK);
+    flexitimer_advance(3);
+    ASSERT_EQ(flexitimer_group_cancel(0), FLEXITIMER_OK);
+    flexitimer_advance(20);
+
+    EXPECT_EQ(callback_count, 0);
+    ASSERT_EQ(flexitimer_get_state(0, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_ERROR_INVALID_STATE);
+}
+
+TEST_F(FlexiTimerTest, NextExpiryAfterGroupCancel)
+{
+    flexitimer_group_t group;
+    timer_time_t ticks;
+
+    ASSERT_EQ(flexitimer_set_groups(&group, 1), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(0, 0, TIMER_TYPE_SINGLESHOT, 3, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start_in_group(1, 0, TIMER_TYPE_PERIODIC, 4, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(2, TIMER_TYPE_SINGLESHOT, 9, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_group_cancel(0), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+#if FLEXITIMER_ENGINE == FLEXITIMER_ENGINE_HEAP
+    EXPECT_EQ(ticks, 9u); // the cancelled members are dropped from the heap top
+#else
+    EXPECT_EQ(ticks, 3u); // the cancelled members come up at their old deadline
+#endif
+
+    /* Either way they never fire */
+    do
+    {
+        flexitimer_advance(ticks);
+    }
+    while(flexitimer_next_expiry(&ticks) == FLEXITIMER_OK);
+
+    EXPECT_EQ(callback_order, (std::vector<timer_id_t> {2}));
+}
+
+TEST_F(FlexiTimerTest, GroupsMatchIndividualOperations)
+{
+    const uint32_t count = 48;
+    const uint32_t group_count = 3;
+    flexitimer_ctx_t grouped, single;
+    flexitimer_timer_t grouped_storage[count], single_storage[count];
+    flexitimer_group_t groups[group_count];
+    int member_of[count]; // group of each timer, applied member by member on the single context
+    bool paused[group_count] = {false, false, false};
+    std::mt19937 random(5);
+
+    ASSERT_EQ(flexitimer_ctx_init(&grouped, grouped_storage, count), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_ctx_init(&single, single_storage, count), FLEXITIMER_OK);
+    use_test_callbacks(&grouped);
+    use_test_callbacks(&single);
+    ASSERT_EQ(flexitimer_ctx_set_groups(&grouped, groups, group_count), FLEXITIMER_OK);
+    std::fill(member_of, member_of + count, -1);
+
+    for(int step = 0; step < 2000; step++)
+    {
+        timer_id_t id = (timer_id_t)(random() % count);
+        uint32_t group = random() % group_count;
+        timer_time_t value = 1u + (random() % 20u);
+        timer_type_t type = ((random() % 2u) != 0u) ? TIMER_TYPE_PERIODIC : TIMER_TYPE_SINGLESHOT;
+
+        switch(random() % 9)
+        {
+            case 0:
+                ASSERT_EQ(flexitimer_ctx_start_in_group(&grouped, id, group, type, value, order_callback), FLEXITIMER_OK);
+                ASSERT_EQ(flexitimer_ctx_start(&single, id, type, value, order_callback), FLEXITIMER_OK);
+                member_of[id] = (int)group;
+
+                if(paused[group])
+                {
+                    ASSERT_EQ(flexitimer_ctx_pause(&single, id), FLEXITIMER_OK);
+                }
+
+                break;
+
+            case 1:
+                ASSERT_EQ(flexitimer_ctx_start(&grouped, id, type, value, order_callback), FLEXITIMER_OK);
+                ASSERT_EQ(flexitimer_ctx_start(&single, id, type, value, order_callback), FLEXITIMER_OK);
+                member_of[id] = -1;
+                break;
+
+            case 2:
+            case 3:
+            {
+                bool pause = (random() % 2u) != 0u;
+                flexitimer_error_t error = pause ? flexitimer_ctx_group_pause(&grouped, group) : flexitimer_ctx_group_resume(&grouped, group);
+                ASSERT_EQ(error, (paused[group] != pause) ? FLEXITIMER_OK : FLEXITIMER_ERROR_INVALID_STATE);
+
+                for(timer_id_t member = 0; (error == FLEXITIMER_OK) && (member < count); member++)
+                {
+                    if(member_of[member] == (int)group)
+                    {
+                        (void)(pause ? flexitimer_ctx_pause(&single, member) : flexitimer_ctx_resume(&single, member));
+                    }
+                }
+
+                paused[group] = pause;
+                break;
+            }
+
+            case 4:
+                ASSERT_EQ(flexitimer_ctx_group_delay(&grouped, group, value), FLEXITIMER_OK);
+
+                for(timer_id_t member = 0; member < count; member++)
+                {
+                    if(member_of[member] == (int)group)
+                    {
+                        (void)flexitimer_ctx_delay(&single, member, value);
+                    }
+                }
+
+                break;
+
+            case 5:
+                ASSERT_EQ(flexitimer_ctx_group_cancel(&grouped, group), FLEXITIMER_OK);
+
+                for(timer_id_t member = 0; member < count; member++)
+                {
+                    if(member_of[member] == (int)group)
+                    {
+                        (void)flexitimer_ctx_cancel(&single, member);
+                    }
+                }
+
+                break;
+
+            case 6:
+                ASSERT_EQ(flexitimer_ctx_delay(&grouped, id, value), flexitimer_ctx_delay(&single, id, value));
+                break;
+
+            case 7:
+                ASSERT_EQ(flexitimer_ctx_cancel(&grouped, id), flexitimer_ctx_cancel(&single, id));
+                break;
+
+            default:
+                callback_order.clear();
+                flexitimer_ctx_advance(&grouped, value);
+                std::vector<timer_id_t> grouped_order = callback_order;
+                callback_order.clear();
+                flexitimer_ctx_advance(&single, value);
+                ASSERT_EQ(grouped_order, callback_order) << "step " << step;
+                break;
+        }
+
+        timer_time_t grouped_next, single_next;
+
+        if(flexitimer_ctx_next_expiry(&single, &single_next) == FLEXITIMER_OK)
+        {
+            ASSERT_EQ(flexitimer_ctx_next_expiry(&grouped, &grouped_next), FLEXITIMER_OK);
+            ASSERT_LE(grouped_next, single_next) << "step " << step; // never later, lazily re-armed members may come earlier
+        }
+
+        for(timer_id_t member = 0; member < count; member++)
+        {
+            timer_state_t grouped_state, single_state;
+            timer_time_t grouped_remaining, single_remaining;
+            (void)flexitimer_ctx_get_state(&grouped, member, &grouped_state);
+            (void)flexitimer_ctx_get_state(&single, member, &single_state);
+            (void)flexitimer_ctx_get_elapsed(&grouped, member, &grouped_remaining);
+            (void)flexitimer_ctx_get_elapsed(&single, member, &single_remaining);
+            ASSERT_EQ(grouped_state, single_state) << "step " << step << " timer " << (int)member;
+            ASSERT_EQ(grouped_remaining, single_remaining) << "step " << step << " timer " << (int)member;
+        }
+    }
+}
+#endif
+
+#if FLEXITIMER_PRIORITIES
+extern "C" {
+    static uint64_t budget_clock_now = 0;
+    uint64_t budget_clock(void)
+    {
+        return budget_clock_now;
+    }
+    void costly_callback(timer_id_t id)
+    {
+        callback_order.push_back(id);
+        budget_clock_now += 10u;
+    }
+}
+
+TEST_F(FlexiTimerTest, PriorityClassesRunInOrder)
+{
+    EXPECT_EQ(flexitimer_set_priority(FLEXITIMER_MAX_TIMERS, FLEXITIMER_PRIORITY_HIGH), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_set_priority(0, (flexitimer_priority_t)4), FLEXITIMER_ERROR_INVALID_ARG);
+    ASSERT_EQ(flexitimer_set_priority(0, FLEXITIMER_PRIORITY_IDLE), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(1, FLEXITIMER_PRIORITY_LOW), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(3, FLEXITIMER_PRIORITY_HIGH), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(5, FLEXITIMER_PRIORITY_HIGH), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < 6; id++)
+    {
+        ASSERT_EQ(flexitimer_start(id, TIMER_TYPE_SINGLESHOT, 2, order_callback), FLEXITIMER_OK);
+    }
+
+    flexitimer_advance(2);
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({3, 5, 2, 4, 1, 0}));
+}
+
+TEST_F(FlexiTimerTest, DispatchBudgetCarriesCallbacksOver)
+{
+    flexitimer_class_stats_t stats;
+    timer_time_t ticks;
+
+    EXPECT_EQ(flexitimer_set_budget(0, 100, NULL), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_get_class_stats((flexitimer_priority_t)4, &stats), FLEXITIMER_ERROR_INVALID_ARG);
+    ASSERT_EQ(flexitimer_set_budget(2, 0, NULL), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(4, FLEXITIMER_PRIORITY_LOW), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(5, FLEXITIMER_PRIORITY_HIGH), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(6, FLEXITIMER_PRIORITY_HIGH), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < 7; id++)
+    {
+        ASSERT_EQ(flexitimer_start(id, TIMER_TYPE_SINGLESHOT, 1, order_callback), FLEXITIMER_OK);
+    }
+
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({5, 6})); // HIGH runs past the budget
+    ASSERT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 1u);
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_NORMAL, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.waiting, 4u);
+    ASSERT_EQ(flexitimer_cancel(2), FLEXITIMER_OK); // drops its waiting callback
+
+    callback_order.clear();
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 1}));
+    callback_order.clear();
+    flexitimer_advance(2);
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({3, 4}));
+    EXPECT_EQ(flexitimer_next_expiry(&ticks), FLEXITIMER_ERROR_INVALID_STATE);
+
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_NORMAL, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.dispatched, 3u);
+    EXPECT_EQ(stats.carried, 3u);
+    EXPECT_EQ(stats.max_wait, 3u);
+    EXPECT_EQ(stats.waiting, 0u);
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_LOW, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.max_wait, 3u);
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_HIGH, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.dispatched, 2u);
+    EXPECT_EQ(stats.carried, 0u);
+
+    /* A starved periodic timer keeps one waiting callback and counts the expiries it missed */
+    flexitimer_reset_class_stats();
+    ASSERT_EQ(flexitimer_set_budget(1, 0, NULL), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(0, TIMER_TYPE_PERIODIC, 1, order_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(4, TIMER_TYPE_PERIODIC, 1, order_callback), FLEXITIMER_OK);
+    callback_order.clear();
+
+    for(int i = 0; i < 5; i++)
+    {
+        flexitimer_handler();
+    }
+
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>(5, 0));
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_LOW, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.dispatched, 0u);
+    EXPECT_EQ(stats.coalesced, 4u);
+    EXPECT_EQ(stats.waiting, 1u);
+    EXPECT_EQ(stats.oldest, 4u);
+
+    ASSERT_EQ(flexitimer_set_budget(0, 0, NULL), FLEXITIMER_OK);
+    flexitimer_handler();
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_LOW, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.dispatched, 1u);
+    EXPECT_EQ(stats.max_wait, 5u);
+    EXPECT_EQ(stats.waiting, 0u);
+}
+
+TEST_F(FlexiTimerTest, PriorityChangeMovesWaitingCallback)
+{
+    flexitimer_class_stats_t stats;
+    ASSERT_EQ(flexitimer_set_budget(1, 0, NULL), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < 4; id++)
+    {
+        ASSERT_EQ(flexitimer_start(id, TIMER_TYPE_SINGLESHOT, 1, order_callback), FLEXITIMER_OK);
+    }
+
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0}));
+
+    /* 1 and 2 leave the NORMAL queue, 3 stays the only one waiting there */
+    ASSERT_EQ(flexitimer_set_priority(2, FLEXITIMER_PRIORITY_HIGH), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_set_priority(1, FLEXITIMER_PRIORITY_LOW), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_NORMAL, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.waiting, 1u);
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_LOW, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.waiting, 1u);
+    EXPECT_EQ(stats.oldest, 0u);
+
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 2}));
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 2, 3}));
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 2, 3, 1}));
+    ASSERT_EQ(flexitimer_get_class_stats(FLEXITIMER_PRIORITY_LOW, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.max_wait, 3u); // waited since its expiry, not since the move
+}
+
+TEST_F(FlexiTimerTest, RestartedTimerQueuesBehindWaitingCallbacks)
+{
+    ASSERT_EQ(flexitimer_set_budget(1, 0, NULL), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < 3; id++)
+    {
+        ASSERT_EQ(flexitimer_set_priority(id, FLEXITIMER_PRIORITY_LOW), FLEXITIMER_OK);
+        ASSERT_EQ(flexitimer_start(id, TIMER_TYPE_SINGLESHOT, 1, order_callback), FLEXITIMER_OK);
+    }
+
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0}));
+
+    /* The dropped callback of 1 is still linked ahead of 2, its new expiry goes behind 2 */
+    ASSERT_EQ(flexitimer_cancel(1), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 1, order_callback), FLEXITIMER_OK);
+    flexitimer_handler();
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 2, 1}));
+}
+
+TEST_F(FlexiTimerTest, DispatchBudgetInClockTime)
+{
+    budget_clock_now = 0;
+    ASSERT_EQ(flexitimer_set_budget(0, 25, budget_clock), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < 5; id++)
+    {
+        ASSERT_EQ(flexitimer_start(id, TIMER_TYPE_SINGLESHOT, 1, costly_callback), FLEXITIMER_OK);
+    }
+
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 1, 2})); // the third one starts within the budget
+    flexitimer_handler();
+    EXPECT_EQ(callback_order, std::vector<timer_id_t>({0, 1, 2, 3, 4}));
+}
+#endif
+
+#if FLEXITIMER_SNAPSHOT
+TEST_F(FlexiTimerTest, SnapshotMatchesGetters)
+{
+    flexitimer_snapshot_t snapshots[FLEXITIMER_MAX_TIMERS];
+    flexitimer_snapshot_t snapshot;
+
+    ASSERT_EQ(flexitimer_start(0, TIMER_TYPE_PERIODIC, 5, test_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(1, TIMER_TYPE_SINGLESHOT, 9, test_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(2, TIMER_TYPE_SINGLESHOT, 2, test_callback), FLEXITIMER_OK);
+    flexitimer_advance(3);
+    ASSERT_EQ(flexitimer_pause(1), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_snapshot_all(snapshots, FLEXITIMER_MAX_TIMERS), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < FLEXITIMER_MAX_TIMERS; id++)
+    {
+        timer_state_t state;
+        timer_type_t type;
+        timer_time_t timeout, remaining;
+        (void)flexitimer_get_state(id, &state);
+        (void)flexitimer_get_type(id, &type);
+        (void)flexitimer_get_time(id, &timeout);
+        (void)flexitimer_get_elapsed(id, &remaining);
+        ASSERT_EQ(flexitimer_snapshot(id, &snapshot), FLEXITIMER_OK);
+        EXPECT_EQ(snapshot.state, state);
+        EXPECT_EQ(snapshot.type, type);
+        EXPECT_EQ(snapshot.timeout, timeout);
+        EXPECT_EQ(snapshot.remaining, remaining);
+        EXPECT_EQ(memcmp(&snapshot, &snapshots[id], sizeof(snapshot)), 0);
+    }
+
+    EXPECT_EQ(snapshots[0].remaining, 2u);
+    EXPECT_EQ(snapshots[1].state, TIMER_STATE_PAUSED);
+    EXPECT_EQ(snapshots[1].remaining, 6u);
+    EXPECT_EQ(snapshots[2].state, TIMER_STATE_PASSIVE);
+    EXPECT_EQ(flexitimer_snapshot(FLEXITIMER_MAX_TIMERS, &snapshot), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_snapshot(0, NULL), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_snapshot_all(snapshots, FLEXITIMER_MAX_TIMERS + 1), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_ctx_snapshot_all(NULL, snapshots, 1), FLEXITIMER_ERROR_INVALID_ARG);
+}
+
+TEST_F(FlexiTimerTest, SnapshotIsNeverTorn)
+{
+    const uint32_t count = 8;
+    flexitimer_ctx_t ctx;
+    flexitimer_timer_t storage[count];
+    std::atomic<bool> done(false);
+    std::atomic<int> reads(0);
+    std::atomic<int> torn(0);
+
+    ASSERT_EQ(flexitimer_ctx_init(&ctx, storage, count), FLEXITIMER_OK);
+    use_test_callbacks(&ctx);
+
+    /* Single-shot timers always get timeouts below 2000, periodic ones from 2000 on */
+    std::thread reader([&]()
+    {
+        flexitimer_snapshot_t snapshots[count];
+
+        while(!done)
+        {
+            (void)flexitimer_ctx_snapshot_all(&ctx, snapshots, count);
+
+            for(uint32_t i = 0; i < count; i++)
+            {
+                const flexitimer_snapshot_t &snapshot = snapshots[i];
+
+                if((snapshot.state != TIMER_STATE_PASSIVE) &&
+                        (((snapshot.type == TIMER_TYPE_PERIODIC) != (snapshot.timeout >= 2000u)) || (snapshot.remaining > snapshot.timeout)))
+                {
+                    torn++;
+                }
+            }
+
+            reads++;
+        }
+    });
+
+    for(uint32_t k = 0; (k < 200000u) || (reads < 100); k++)
+    {
+        timer_id_t id = (timer_id_t)(k % count);
+
+        if((k % 3u) == 0u)
+        {
+            (void)flexitimer_ctx_start(&ctx, id, TIMER_TYPE_SINGLESHOT, 1000u + (k % 997u), test_callback);
+        }
+        else if((k % 3u) == 1u)
+        {
+            (void)flexitimer_ctx_start(&ctx, id, TIMER_TYPE_PERIODIC, 2000u + (k % 997u), test_callback);
+        }
+        else
+        {
+            (void)flexitimer_ctx_pause(&ctx, id);
+        }
+
+        flexitimer_ctx_advance(&ctx, 1u + (k % 5u));
+    }
+
+    done = true;
+    reader.join();
+    EXPECT_EQ(torn, 0);
+}
+#endif
+
+#if FLEXITIMER_TRACE
+static uint64_t trace_now = 0;
+static uint64_t trace_clock(void)
+{
+    return ++trace_now;
+}
+
+TEST_F(FlexiTimerTest, TraceRecordsOperationsTicksAndFires)
+{
+    flexitimer_trace_event_t buffer[32];
+    flexitimer_trace_event_t events[32];
+    const struct
+    {
+        flexitimer_trace_type_t type;
+        uint32_t id;
+        timer_time_t value;
+        timer_time_t tick;
+    } expected[] =
+    {
+        {FLEXITIMER_TRACE_START, 3, 2, 0},
+        {FLEXITIMER_TRACE_DELAY, 3, 1, 0},
+        {FLEXITIMER_TRACE_TICK_BEGIN, 0, 2, 0},
+        {FLEXITIMER_TRACE_TICK_END, 0, 0, 2},
+        {FLEXITIMER_TRACE_TICK_BEGIN, 0, 1, 2},
+        {FLEXITIMER_TRACE_FIRE_BEGIN, 3, 0, 3},
+        {FLEXITIMER_TRACE_FIRE_END, 3, 0, 3},
+        {FLEXITIMER_TRACE_TICK_END, 0, 0, 3},
+        {FLEXITIMER_TRACE_RESTART, 3, 0, 3},
+        {FLEXITIMER_TRACE_CANCEL, 3, 0, 3},
+    };
+    const uint32_t count = sizeof(expected) / sizeof(expected[0]);
+
+    EXPECT_EQ(sizeof(flexitimer_trace_event_t), 24u);
+    ASSERT_EQ(flexitimer_set_trace(buffer, 32, trace_clock), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_start(3, TIMER_TYPE_SINGLESHOT, 2, test_callback), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_delay(3, 1), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_resume(3), FLEXITIMER_ERROR_INVALID_STATE); // failed operations are not recorded
+    flexitimer_advance(2);
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 1);
+    ASSERT_EQ(flexitimer_restart(3), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_cancel(3), FLEXITIMER_OK);
+
+    ASSERT_EQ(flexitimer_trace_read(events, 32), count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(events[i].type, (uint8_t)expected[i].type) << "event " << i;
+        EXPECT_EQ(events[i].id, expected[i].id) << "event " << i;
+        EXPECT_EQ(events[i].value, expected[i].value) << "event " << i;
+        EXPECT_EQ(events[i].tick, expected[i].tick) << "event " << i;
+        EXPECT_EQ(events[i].clock, trace_now - count + 1 + i) << "event " << i;
+    }
+
+#if FLEXITIMER_GROUPS
+    /* Group events carry the group index */
+    flexitimer_group_t groups[2];
+    ASSERT_EQ(flexitimer_set_groups(groups, 2), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_group_pause(1), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_group_pause(1), FLEXITIMER_ERROR_INVALID_STATE);
+    ASSERT_EQ(flexitimer_group_resume(1), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_group_delay(1, 4), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_group_cancel(1), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_trace_read(events, 4), 4u);
+    EXPECT_EQ(events[0].type, (uint8_t)FLEXITIMER_TRACE_GROUP_PAUSE);
+    EXPECT_EQ(events[1].type, (uint8_t)FLEXITIMER_TRACE_GROUP_RESUME);
+    EXPECT_EQ(events[2].type, (uint8_t)FLEXITIMER_TRACE_GROUP_DELAY);
+    EXPECT_EQ(events[2].value, 4u);
+    EXPECT_EQ(events[3].type, (uint8_t)FLEXITIMER_TRACE_GROUP_CANCEL);
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(events[i].id, 1u) << "event " << i;
+        EXPECT_EQ(events[i].tick, 3u) << "event " << i;
+    }
+#endif
+
+#if FLEXITIMER_HANDLES
+    /* Handle events carry the timer id and the generation of the handle */
+    flexitimer_handle_t handle;
+    timer_id_t id;
+    ASSERT_EQ(flexitimer_create(&handle), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_handle_id(handle, &id), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_destroy(handle), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_destroy(handle), FLEXITIMER_ERROR_INVALID_ID);
+    ASSERT_EQ(flexitimer_trace_read(events, 3), 3u);
+    EXPECT_EQ(events[0].type, (uint8_t)FLEXITIMER_TRACE_HANDLE_CREATE);
+    EXPECT_EQ(events[1].type, (uint8_t)FLEXITIMER_TRACE_CANCEL);
+    EXPECT_EQ(events[2].type, (uint8_t)FLEXITIMER_TRACE_HANDLE_DESTROY);
+
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(events[i].id, (uint32_t)id) << "event " << i;
+    }
+
+    EXPECT_EQ(events[0].value, events[2].value);
+#endif
+}
+
+TEST_F(FlexiTimerTest, TraceBufferKeepsLatestEvents)
+{
+    flexitimer_trace_event_t buffer[4];
+    flexitimer_trace_event_t events[8];
+
+    EXPECT_EQ(flexitimer_trace_read(events, 8), 0u);
+    EXPECT_EQ(flexitimer_set_trace(buffer, 3, NULL), FLEXITIMER_ERROR_INVALID_ARG);
+    ASSERT_EQ(flexitimer_set_trace(buffer, 4, NULL), FLEXITIMER_OK);
+
+    for(timer_id_t id = 0; id < 6; id++)
+    {
+        ASSERT_EQ(flexitimer_start(id, TIMER_TYPE_PERIODIC, 10u + id, test_callback), FLEXITIMER_OK);
+    }
+
+    /* The oldest event of the full buffer is the one the next event replaces */
+    ASSERT_EQ(flexitimer_trace_read(events, 8), 3u);
+
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(events[i].type, (uint8_t)FLEXITIMER_TRACE_START);
+        EXPECT_EQ(events[i].id, 3u + i);
+        EXPECT_EQ(events[i].value, 13u + i);
+        EXPECT_EQ(events[i].clock, 0u);
+    }
+
+    EXPECT_EQ(flexitimer_trace_read(events, 2), 2u);
+    EXPECT_EQ(events[0].id, 4u);
+    ASSERT_EQ(flexitimer_set_trace(NULL, 0, NULL), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_trace_read(events, 8), 0u);
+}
+#endif
+
+#if FLEXITIMER_HANDLES
+TEST_F(FlexiTimerTest, HandleIsStaleAfterDestroyAndReuse)
+{
+    flexitimer_handle_t first, second;
+    timer_id_t first_id, second_id;
+    timer_state_t state;
+
+    ASSERT_EQ(flexitimer_create(&first), FLEXITIMER_OK);
+    EXPECT_NE(first, FLEXITIMER_HANDLE_INVALID);
+    EXPECT_EQ(flexitimer_handle_start(first, TIMER_TYPE_PERIODIC, 2, test_callback), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_handle_id(first, &first_id), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_destroy(first), FLEXITIMER_OK);
+
+    ASSERT_EQ(flexitimer_create(&second), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_handle_id(second, &second_id), FLEXITIMER_OK);
+    EXPECT_EQ(first_id, second_id); // the released timer is reused first
+    EXPECT_NE(first, second);
+    EXPECT_EQ(flexitimer_handle_get_state(second, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+
+    EXPECT_EQ(flexitimer_handle_cancel(first), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_handle_start(first, TIMER_TYPE_SINGLESHOT, 1, test_callback), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_destroy(first), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_handle_get_state(FLEXITIMER_HANDLE_INVALID, &state), FLEXITIMER_ERROR_INVALID_ID);
+
+    flexitimer_handler();
+    flexitimer_handler();
+    EXPECT_EQ(callback_count, 0);
+}
+
+TEST_F(FlexiTimerTest, CreateFailsWhenPoolIsEmpty)
+{
+    flexitimer_handle_t handles[FLEXITIMER_MAX_TIMERS];
+    flexitimer_handle_t extra;
+
+    for(int i = 0; i < FLEXITIMER_MAX_TIMERS; i++)
+    {
+        ASSERT_EQ(flexitimer_create(&handles[i]), FLEXITIMER_OK);
+    }
+
+    EXPECT_EQ(flexitimer_create(&extra), FLEXITIMER_ERROR_FULL);
+    EXPECT_EQ(flexitimer_create(nullptr), FLEXITIMER_ERROR_INVALID_ARG);
+    EXPECT_EQ(flexitimer_destroy(handles[3]), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_create(&extra), FLEXITIMER_OK);
+}
+
+#if FLEXITIMER_ID_BITS == 32
+TEST_F(FlexiTimerTest, PoolServesAMillionTimers)
+{
+    const uint32_t capacity = 1000000;
+    std::vector<flexitimer_timer_t> storage(capacity);
+    std::vector<flexitimer_handle_t> handles(capacity);
+    flexitimer_ctx_t ctx;
+    flexitimer_handle_t extra;
+    timer_id_t id;
+
+    ASSERT_EQ(flexitimer_ctx_init(&ctx, storage.data(), capacity), FLEXITIMER_OK);
+    use_test_callbacks(&ctx);
+
+    for(uint32_t i = 0; i < capacity; i++)
+    {
+        ASSERT_EQ(flexitimer_ctx_create(&ctx, &handles[i]), FLEXITIMER_OK);
+    }
+
+    EXPECT_EQ(flexitimer_ctx_create(&ctx, &extra), FLEXITIMER_ERROR_FULL);
+    EXPECT_EQ(flexitimer_ctx_handle_start(&ctx, handles[capacity - 1], TIMER_TYPE_SINGLESHOT, 2, order_callback), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_ctx_handle_start(&ctx, handles[300], TIMER_TYPE_SINGLESHOT, 2, order_callback), FLEXITIMER_OK);
+    flexitimer_ctx_advance(&ctx, 2);
+    std::vector<timer_id_t> expected = {300, capacity - 1};
+    EXPECT_EQ(callback_order, expected);
+
+    EXPECT_EQ(flexitimer_ctx_destroy(&ctx, handles[500000]), FLEXITIMER_OK);
+    ASSERT_EQ(flexitimer_ctx_create(&ctx, &extra), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_ctx_handle_id(&ctx, extra, &id), FLEXITIMER_OK);
+    EXPECT_EQ(id, 500000u);
+    EXPECT_EQ(flexitimer_ctx_handle_restart(&ctx, handles[500000]), FLEXITIMER_ERROR_INVALID_ID);
+}
+#endif
+#endif
+
+#if FLEXITIMER_SCAN_SOA
+TEST_F(FlexiTimerTest, SoaContextIsBoundedByMaxTimers)
+{
+    flexitimer_ctx_t ctx;
+    std::vector<flexitimer_timer_t> storage(FLEXITIMER_MAX_TIMERS + 1);
+
+    EXPECT_EQ(flexitimer_ctx_init(&ctx, storage.data(), FLEXITIMER_MAX_TIMERS + 1), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_ctx_init(&ctx, storage.data(), FLEXITIMER_MAX_TIMERS), FLEXITIMER_OK);
+    use_test_callbacks(&ctx);
+}
+#endif
+
+#if FLEXITIMER_STATS
+extern "C" {
+    static uint64_t fake_clock_now = 0;
+    uint64_t fake_clock(void)
+    {
+        return fake_clock_now;
+    }
+    void slow_callback(timer_id_t id)
+    {
+        fake_clock_now += 100u * (id + 1u);
+    }
+}
+
+TEST_F(FlexiTimerTest, StatsTrackFiresAndCallbackDurations)
+{
+    flexitimer_stats_t stats;
+
+    flexitimer_set_clock(fake_clock, 150);
+    flexitimer_start(0, TIMER_TYPE_PERIODIC, 1, slow_callback);
+    flexitimer_start(1, TIMER_TYPE_PERIODIC, 2, slow_callback);
+
+    for(int i = 0; i < 4; i++)
+    {
+        flexitimer_handler();
+    }
+
+    ASSERT_EQ(flexitimer_get_stats(0, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.fires, 4u);
+    EXPECT_EQ(stats.overruns, 0u);
+    EXPECT_EQ(stats.total_time, 400u);
+    EXPECT_EQ(stats.max_time, 100u);
+    EXPECT_EQ(stats.histogram[7], 4u); // 64 to 127
+
+    ASSERT_EQ(flexitimer_get_stats(1, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.fires, 2u);
+    EXPECT_EQ(stats.overruns, 2u);
+    EXPECT_EQ(stats.max_time, 200u);
+    EXPECT_EQ(stats.histogram[8], 2u); // 128 to 255
+
+    flexitimer_reset_stats();
+    ASSERT_EQ(flexitimer_get_stats(1, &stats), FLEXITIMER_OK);
+    EXPECT_EQ(stats.fires, 0u);
+    EXPECT_EQ(stats.histogram[8], 0u);
+    EXPECT_EQ(flexitimer_get_stats(FLEXITIMER_MAX_TIMERS, &stats), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_get_stats(0, nullptr), FLEXITIMER_ERROR_INVALID_ARG);
+}
+#endif
+
+TEST_F(FlexiTimerTest, StaticTableRunsWithoutInit)
+{
+    timer_time_t ticks;
+    ASSERT_EQ(flexitimer_static_next_expiry(&phased_table, &ticks), FLEXITIMER_OK);
+    EXPECT_EQ(ticks, 2u);
+
+    for(int i = 0; i < 8; i++)
+    {
+        flexitimer_static_handler(&phased_table);
+    }
+
+    // phase 2 puts timer 0 between the expiries of timer 1, id 7 is a single-shot
+    std::vector<timer_id_t> expected = {0, 7, 1, 0, 1};
+    EXPECT_EQ(callback_order, expected);
+
+    timer_state_t state;
+    EXPECT_EQ(flexitimer_static_get_state(&phased_table, 7, &state), FLEXITIMER_OK);
+    EXPECT_EQ(state, TIMER_STATE_PASSIVE);
+    EXPECT_EQ(flexitimer_static_get_state(&phased_table, 2, &state), FLEXITIMER_ERROR_INVALID_ID);
+    EXPECT_EQ(flexitimer_static_get_state(nullptr, 0, &state), FLEXITIMER_ERROR_INVALID_ARG);
+}
+
+TEST_F(FlexiTimerTest, StaticTableControls)
+{
+    timer_time_t remaining;
+    flexitimer_static_handler(&control_table);
+    EXPECT_EQ(flexitimer_static_pause(&control_table, 0), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_static_pause(&control_table, 0), FLEXITIMER_ERROR_INVALID_STATE);
+    flexitimer_static_handler(&control_table);
+    flexitimer_static_handler(&control_table);
+    EXPECT_EQ(flexitimer_static_get_elapsed(&control_table, 0, &remaining), FLEXITIMER_OK);
+    EXPECT_EQ(remaining, 2u);
+    EXPECT_EQ(flexitimer_static_resume(&control_table, 0), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_static_resume(&control_table, 0), FLEXITIMER_ERROR_INVALID_STATE);
+    flexitimer_static_handler(&control_table);
+    flexitimer_static_handler(&control_table);
+    EXPECT_EQ(callback_count, 1);
+
+    EXPECT_EQ(flexitimer_static_cancel(&control_table, 1), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_static_pause(&control_table, 1), FLEXITIMER_ERROR_INVALID_STATE);
+    flexitimer_static_advance(&control_table, 10);
+    EXPECT_EQ(callback_count, 3);
+
+    EXPECT_EQ(flexitimer_static_restart(&control_table, 1), FLEXITIMER_OK);
+    EXPECT_EQ(flexitimer_static_get_elapsed(&control_table, 1, &remaining), FLEXITIMER_OK);
+    EXPECT_EQ(remaining, 7u);
+}
+
+TEST_F(FlexiTimerTest, StaticAdvanceMatchesHandler)
+{
+    flexitimer_static_advance(&advance_table, 40);
+    std::vector<timer_id_t> advanced = callback_order;
+    callback_order.clear();
+
+    // rewind to startup, as after a reset
+    for(uint32_t i = 0; i < advance_table.count; i++)
+    {
+        advance_table.counters[i].elapsed = 0;
+        advance_table.counters[i].flags = 0;
+    }
+
+    for(int i = 0; i < 40; i++)
+    {
+        flexitimer_static_handler(&advance_table);
+    }
+
+    EXPECT_EQ(advanced, callback_order);
+    EXPECT_EQ(advanced.size(), 7u + 5u + 1u);
+}
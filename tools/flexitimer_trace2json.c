@@ -0,0 +1,182 @@
+/**
+    @file flexitimer_trace2json.c
+    @brief FlexiTimer Scheduler Library - trace converter
+
+    Converts a binary event trace, the flexitimer_trace_event_t records returned by
+    flexitimer_trace_read() written to a file as they are, to the Chrome trace event JSON
+    format that chrome://tracing and ui.perfetto.dev open. Ticks and callbacks become nested
+    slices, the timer, group and handle operations instant events. The records are read little-endian, field by
+    field, so traces of other targets convert as well.
+
+    flexitimer_trace2json [-c clock units per us] [-t us per tick] trace.bin [trace.json]
+
+    Events are placed by their clock timestamp, or by their tick when they have none.
+
+    @date 2010-02-18
+    @version 1.0
+    @author Eray Ozturk | erayozturk1@gmail.com
+    @url github.com/diffstorm
+    @license MIT License
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flexitimer.h"
+
+#define RECORD_SIZE (24u)
+
+static const char *const operation_names[] =
+{
+    "start", "delay", "pause", "resume", "restart", "cancel"
+};
+
+static const char *const group_names[] =
+{
+    "group pause", "group resume", "group cancel", "group delay"
+};
+
+static const char *const handle_names[] =
+{
+    "create", "destroy"
+};
+
+/* Reads a little-endian value of the given number of bytes */
+static uint64_t read_le(const unsigned char *bytes, uint32_t size)
+{
+    uint64_t value = 0;
+
+    for(uint32_t i = size; i > 0u; i--)
+    {
+        value = (value << 8u) | bytes[i - 1u];
+    }
+
+    return value;
+}
+
+/* Writes one record as a trace event, returns 0 if its type is unknown */
+static int write_event(FILE *out, const unsigned char *record, double clock_per_us, double us_per_tick, int first)
+{
+    uint64_t clock = read_le(&record[0], 8u);
+    uint32_t tick = (uint32_t)read_le(&record[8], 4u);
+    uint32_t id = (uint32_t)read_le(&record[12], 4u);
+    uint32_t value = (uint32_t)read_le(&record[16], 4u);
+    uint8_t type = record[20];
+    double ts = (clock != 0u) ? ((double)clock / clock_per_us) : ((double)tick * us_per_tick);
+    const char *separator = first ? "" : ",\n";
+
+    switch(type)
+    {
+        case FLEXITIMER_TRACE_TICK_BEGIN:
+        case FLEXITIMER_TRACE_TICK_END:
+            fprintf(out, "%s{\"name\":\"tick\",\"cat\":\"tick\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"tick\":%u,\"ticks\":%u}}",
+                    separator, (type == FLEXITIMER_TRACE_TICK_BEGIN) ? "B" : "E", ts, tick, value);
+            return 1;
+
+        case FLEXITIMER_TRACE_FIRE_BEGIN:
+        case FLEXITIMER_TRACE_FIRE_END:
+            fprintf(out, "%s{\"name\":\"timer %u\",\"cat\":\"fire\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"id\":%u,\"tick\":%u}}",
+                    separator, id, (type == FLEXITIMER_TRACE_FIRE_BEGIN) ? "B" : "E", ts, id, tick);
+            return 1;
+
+        case FLEXITIMER_TRACE_GROUP_PAUSE:
+        case FLEXITIMER_TRACE_GROUP_RESUME:
+        case FLEXITIMER_TRACE_GROUP_CANCEL:
+        case FLEXITIMER_TRACE_GROUP_DELAY:
+            fprintf(out, "%s{\"name\":\"%s %u\",\"cat\":\"group\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"group\":%u,\"value\":%u,\"tick\":%u}}",
+                    separator, group_names[type - FLEXITIMER_TRACE_GROUP_PAUSE], id, ts, id, value, tick);
+            return 1;
+
+        case FLEXITIMER_TRACE_HANDLE_CREATE:
+        case FLEXITIMER_TRACE_HANDLE_DESTROY:
+            fprintf(out, "%s{\"name\":\"%s %u\",\"cat\":\"handle\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"id\":%u,\"generation\":%u,\"tick\":%u}}",
+                    separator, handle_names[type - FLEXITIMER_TRACE_HANDLE_CREATE], id, ts, id, value, tick);
+            return 1;
+
+        default:
+            if(type <= FLEXITIMER_TRACE_CANCEL)
+            {
+                fprintf(out, "%s{\"name\":\"%s %u\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"id\":%u,\"value\":%u,\"tick\":%u}}",
+                        separator, operation_names[type], id, operation_names[type], ts, id, value, tick);
+                return 1;
+            }
+
+            return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    double clock_per_us = 1000.0; // nanosecond clock
+    double us_per_tick = 1000.0;  // 1 ms ticks
+    const char *input = NULL;
+    const char *output = NULL;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-c") == 0) && ((i + 1) < argc))
+        {
+            clock_per_us = atof(argv[++i]);
+        }
+        else if((strcmp(argv[i], "-t") == 0) && ((i + 1) < argc))
+        {
+            us_per_tick = atof(argv[++i]);
+        }
+        else if(input == NULL)
+        {
+            input = argv[i];
+        }
+        else
+        {
+            output = argv[i];
+        }
+    }
+
+    if((input == NULL) || (clock_per_us <= 0.0))
+    {
+        fprintf(stderr, "usage: %s [-c clock units per us] [-t us per tick] trace.bin [trace.json]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = fopen(input, "rb");
+    FILE *out = (output != NULL) ? fopen(output, "w") : stdout;
+
+    if((in == NULL) || (out == NULL))
+    {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], (in == NULL) ? input : output);
+        return 1;
+    }
+
+    unsigned char record[RECORD_SIZE];
+    unsigned long events = 0;
+    unsigned long skipped = 0;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    while(fread(record, 1, RECORD_SIZE, in) == RECORD_SIZE)
+    {
+        if(write_event(out, record, clock_per_us, us_per_tick, events == 0u) != 0)
+        {
+            events++;
+        }
+        else
+        {
+            skipped++;
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    fclose(in);
+
+    if(out != stdout)
+    {
+        fclose(out);
+    }
+
+    if(skipped > 0u)
+    {
+        fprintf(stderr, "%s: %lu records of unknown type skipped\n", argv[0], skipped);
+    }
+
+    return 0;
+}